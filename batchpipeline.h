@@ -0,0 +1,184 @@
+// --------------------- batchpipeline.h ----------------------------------
+//
+// Ethan Thomas
+// ------------------------------------------------------------------------
+// --Purpose: Process a file holding many graphs as a pipeline instead of
+//   one graph at a time. One thread parses graphs off the input with
+//   buildGraph(), a pool of workers solves and formats them, and the
+//   calling thread writes the formatted text to the output.
+// ------------------------------------------------------------------------
+// Assumptions:
+// --Graph is GraphM or GraphL: default constructible, movable, and has
+//   buildGraph(istream&, ostream& errors).
+// --process solves one graph and prints it to the given stream. It runs on
+//   several workers at once, each with its own graph.
+// --Output is written in input order, exactly as the sequential loop in
+//   driver.cpp would write it, including the error lines buildGraph()
+//   reports and a last graph cut short by the end of the file.
+// --At most 4 graphs per worker are between parsing and writing at any
+//   time, so memory stays bounded however long the input is.
+// --Each stage names its threads for trace exports (see trace.h).
+// ------------------------------------------------------------------------
+
+#ifndef BATCHPIPELINE_H
+#define BATCHPIPELINE_H
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <map>
+#include <thread>
+#include <vector>
+#include "boundedqueue.h"
+#include "trace.h"
+
+
+const int BATCH_WINDOW_PER_WORKER = 4; //graphs in flight per worker
+
+// ----------------------BatchJob--------------------------------------------
+// --One parsed graph on its way from the parser to a worker.
+// --------------------------------------------------------------------------
+template <typename Graph>
+struct BatchJob
+{
+	long sequence;         // position in the input
+	bool complete;         // false for a graph cut short by end of file
+	std::string errors;    // what buildGraph() reported
+	Graph graph;
+};
+
+// ----------------------BatchResult-----------------------------------------
+// --The formatted output of one graph on its way to the writer.
+// --------------------------------------------------------------------------
+struct BatchResult
+{
+	long sequence;         // position in the input
+	std::string text;      // everything printed for this graph
+};
+
+// ----------------------runBatch()------------------------------------------
+// --Reads every graph from infile, runs process on each with workers
+//   threads, and writes the results to out in input order. Returns the
+//   number of complete graphs processed.
+// --------------------------------------------------------------------------
+template <typename Graph>
+long runBatch(std::istream& infile, std::ostream& out, int workers,
+	void (*process)(Graph& graph, std::ostream& out))
+{
+	if (workers < 1)
+	{
+		workers = 1;
+	}
+
+	const int window = workers * BATCH_WINDOW_PER_WORKER;
+
+	BoundedQueue<BatchJob<Graph> > parsed(window);   // parser -> workers
+	BoundedQueue<BatchResult> formatted(window);     // workers -> writer
+	BoundedQueue<int> tickets(window);               // caps graphs in flight
+
+	for (int i = 0; i < window; i++)
+	{
+		tickets.push(0);
+	}
+
+	long processed = 0;   // complete graphs, written by the parser
+
+	// parse stage: one thread, since the input is read in order
+	std::thread parser([&]()
+	{
+		int ticket = 0;
+
+		Trace::nameThread("parser");
+
+		for (long sequence = 0; tickets.pop(ticket); ++sequence)
+		{
+			BatchJob<Graph> job;
+			std::ostringstream errors;
+			bool complete = false;
+
+			job.graph.buildGraph(infile, errors);
+			complete = !infile.eof(); // same test as the sequential loop
+
+			job.sequence = sequence;
+			job.complete = complete;
+			job.errors = errors.str();
+			parsed.push(std::move(job));
+
+			if (!complete)
+			{
+				break;
+			}
+
+			++processed;
+		}
+
+		parsed.close();
+	});
+
+	// solve and format stage: each worker handles whole graphs
+	std::vector<std::thread> pool;
+
+	for (int i = 0; i < workers; i++)
+	{
+		pool.push_back(std::thread([&]()
+		{
+			BatchJob<Graph> job;
+
+			Trace::nameThread("worker");
+
+			while (parsed.pop(job))
+			{
+				std::ostringstream text;
+				text << job.errors;
+
+				if (job.complete)
+				{
+					process(job.graph, text);
+				}
+
+				BatchResult result;
+				result.sequence = job.sequence;
+				result.text = text.str();
+				formatted.push(std::move(result));
+
+				job.graph = Graph(); // release the graph before waiting again
+			}
+		}));
+	}
+
+	std::thread closer([&]()
+	{
+		for (size_t i = 0; i < pool.size(); i++)
+		{
+			pool[i].join();
+		}
+
+		formatted.close();
+	});
+
+	// write stage: put results back in input order
+	std::map<long, std::string> pending;
+	long next = 0;
+	BatchResult result;
+
+	Trace::nameThread("writer");
+
+	while (formatted.pop(result))
+	{
+		pending[result.sequence] = std::move(result.text);
+
+		while (!pending.empty() && pending.begin()->first == next)
+		{
+			out << pending.begin()->second;
+			pending.erase(pending.begin());
+			++next;
+			tickets.push(0); // lets the parser take another graph
+		}
+	}
+
+	parser.join();
+	closer.join();
+
+	return processed;
+}
+
+#endif // !BATCHPIPELINE_H
@@ -0,0 +1,112 @@
+// --------------------- boundedqueue.h -----------------------------------
+//
+// Ethan Thomas
+// ------------------------------------------------------------------------
+// --Purpose: A fixed-capacity FIFO queue connecting the stages of the
+//   batch pipeline. Producers block while it is full and consumers block
+//   while it is empty, so a fast stage cannot run arbitrarily far ahead of
+//   a slow one.
+// ------------------------------------------------------------------------
+// Assumptions:
+// --Any number of threads may push and pop at the same time.
+// --close() is called once no more items will be pushed. pop() keeps
+//   handing out what is left and then returns false.
+// ------------------------------------------------------------------------
+
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+
+template <typename Item>
+class BoundedQueue
+{
+
+public:
+	explicit BoundedQueue(const int& capacity);
+
+	BoundedQueue(const BoundedQueue&) = delete;
+	BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+	void push(Item item);
+	bool pop(Item& item);
+	void close();
+
+
+
+private:
+
+	std::deque<Item> items;              // queued items, oldest first
+	size_t capacity;                     // most items held at once
+	bool closed;                         // no more pushes will come
+	std::mutex lock;                     // guards items and closed
+	std::condition_variable notFull;     // signalled when an item is popped
+	std::condition_variable notEmpty;    // signalled when an item is pushed or on close
+
+
+};
+
+// -----------------------Constructor----------------------------------------
+// --Constructs an open, empty queue holding at most capacity items.
+// --------------------------------------------------------------------------
+template <typename Item>
+BoundedQueue<Item>::BoundedQueue(const int& capacity)
+	: capacity(capacity > 0 ? capacity : 1), closed(false)
+{
+}
+
+// --------------------------push()------------------------------------------
+// --Adds item to the back of the queue, waiting while the queue is full.
+// --------------------------------------------------------------------------
+template <typename Item>
+void BoundedQueue<Item>::push(Item item)
+{
+	std::unique_lock<std::mutex> guard(lock);
+	notFull.wait(guard, [this]() { return items.size() < capacity; });
+
+	items.push_back(std::move(item));
+
+	guard.unlock();
+	notEmpty.notify_one();
+}
+
+// --------------------------pop()-------------------------------------------
+// --Removes the front item into item, waiting while the queue is empty.
+//   Returns false once the queue is closed and drained.
+// --------------------------------------------------------------------------
+template <typename Item>
+bool BoundedQueue<Item>::pop(Item& item)
+{
+	std::unique_lock<std::mutex> guard(lock);
+	notEmpty.wait(guard, [this]() { return !items.empty() || closed; });
+
+	if (items.empty()) // closed and drained
+	{
+		return false;
+	}
+
+	item = std::move(items.front());
+	items.pop_front();
+
+	guard.unlock();
+	notFull.notify_one();
+	return true;
+}
+
+// --------------------------close()-----------------------------------------
+// --Marks the queue closed and wakes every waiting consumer.
+// --------------------------------------------------------------------------
+template <typename Item>
+void BoundedQueue<Item>::close()
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		closed = true;
+	}
+
+	notEmpty.notify_all();
+}
+
+#endif // !BOUNDEDQUEUE_H
@@ -0,0 +1,722 @@
+// -------------------- compressedgraph.cpp -------------------------------
+//
+// Ethan Thomas
+//
+// --------------------------------------------------------------------------
+#include "compressedgraph.h"
+#include <algorithm>
+#include <climits>
+
+const char CompressedGraph::FILE_MAGIC[8] = { 'C', 'G', 'R', 'A', 'P', 'H', '1', '\0' };
+
+// -----------------------Default Constructor--------------------------------
+// --Constructs a graph without nodes.
+// --------------------------------------------------------------------------
+CompressedGraph::CompressedGraph()
+{
+	makeEmpty();
+}
+
+// -----------------------Constructor----------------------------------------
+// --Packs edges into a graph of size nodes. Edges are sorted by source and
+//   destination; of a repeated edge only the last one given is kept.
+//   Edges that isValidEdge() rejects are dropped.
+// --------------------------------------------------------------------------
+CompressedGraph::CompressedGraph(const int& size, std::vector<Edge> edges, const bool& weighted)
+	: size(size > 0 ? size : 0), weighted(weighted), edgeCount(0)
+{
+	std::shared_ptr<Buffers> buffers = std::make_shared<Buffers>();
+	std::vector<uint32_t> values;
+
+	edges.erase(std::remove_if(edges.begin(), edges.end(), [this](const Edge& edge)
+	{
+		return !isValidEdge(edge, this->size, this->weighted);
+	}), edges.end());
+
+	std::stable_sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b)
+	{
+		return a.source < b.source || (a.source == b.source && a.destination < b.destination);
+	});
+
+	buffers->offset.assign(this->size + 2, 0);
+	buffers->degree.assign(this->size + 2, 0);
+
+	std::vector<Edge>::const_iterator first = edges.begin();
+
+	for (int v = 0; v <= this->size + 1; v++)
+	{
+		std::vector<Edge>::const_iterator last = first;
+
+		while (last != edges.end() && last->source == v)
+		{
+			++last;
+		}
+
+		buffers->offset[v] = buffers->bytes.size();
+		buffers->degree[v] = encodeNode(first, last, weighted, values, buffers->bytes);
+		edgeCount += buffers->degree[v];
+		first = last;
+	}
+
+	buffers->bytes.shrink_to_fit();
+	pointAt(buffers);
+}
+
+// -------------------------Move Constructor---------------------------------
+// --Takes over other's storage in O(1). other is left as an empty graph.
+// --------------------------------------------------------------------------
+CompressedGraph::CompressedGraph(CompressedGraph&& other) noexcept
+	: size(other.size), weighted(other.weighted), edgeCount(other.edgeCount),
+	  owned(std::move(other.owned)), mapping(std::move(other.mapping)),
+	  offset(other.offset), degree(other.degree), bytes(other.bytes),
+	  byteCount(other.byteCount)
+{
+	other.makeEmpty();
+}
+
+// -------------------------operator=(move)----------------------------------
+// --Takes over rhs's storage in O(1). rhs is left as an empty graph.
+// --------------------------------------------------------------------------
+CompressedGraph& CompressedGraph::operator=(CompressedGraph&& rhs) noexcept
+{
+	if (this != &rhs)
+	{
+		size = rhs.size;
+		weighted = rhs.weighted;
+		edgeCount = rhs.edgeCount;
+		owned = std::move(rhs.owned);
+		mapping = std::move(rhs.mapping);
+		offset = rhs.offset;
+		degree = rhs.degree;
+		bytes = rhs.bytes;
+		byteCount = rhs.byteCount;
+		rhs.makeEmpty();
+	}
+
+	return *this;
+}
+
+// ---------------------------makeEmpty()------------------------------------
+// --Helper function that makes *this a graph without nodes, pointing at
+//   the storage shared by every empty graph.
+// --------------------------------------------------------------------------
+void CompressedGraph::makeEmpty()
+{
+	size = 0;
+	weighted = false;
+	edgeCount = 0;
+	pointAt(emptyBuffers());
+}
+
+// --------------------------emptyBuffers()----------------------------------
+// --Helper function returning the storage shared by every empty graph:
+//   offsets and degrees of 0 for nodes 0 and 1, and no bytes.
+// --------------------------------------------------------------------------
+const std::shared_ptr<const CompressedGraph::Buffers>& CompressedGraph::emptyBuffers()
+{
+	static const std::shared_ptr<const Buffers> empty = []()
+	{
+		std::shared_ptr<Buffers> buffers = std::make_shared<Buffers>();
+		buffers->offset.assign(2, 0);
+		buffers->degree.assign(2, 0);
+		return std::shared_ptr<const Buffers>(buffers);
+	}();
+
+	return empty;
+}
+
+// ----------------------pointAt()-------------------------------------------
+// --Helper function that makes buffers the storage of the graph.
+// --------------------------------------------------------------------------
+void CompressedGraph::pointAt(const std::shared_ptr<const Buffers>& buffers)
+{
+	owned = buffers;
+	mapping.reset();
+	offset = buffers->offset.data();
+	degree = buffers->degree.data();
+	bytes = buffers->bytes.data();
+	byteCount = buffers->bytes.size();
+}
+
+// ----------------------isValidEdge()---------------------------------------
+// --Helper function returning true if both ends of edge are nodes 1 to size
+//   and, for a weighted graph, its weight is not negative.
+// --------------------------------------------------------------------------
+bool CompressedGraph::isValidEdge(const Edge& edge, const int& size, const bool& weighted)
+{
+	return edge.source > 0 && edge.source <= size &&
+		edge.destination > 0 && edge.destination <= size &&
+		(!weighted || edge.weight >= 0);
+}
+
+// ----------------------encodeNode()----------------------------------------
+// --Helper function that appends the packed neighbours of one node to out.
+//   first to last are that node's edges, sorted by destination; of a
+//   repeated edge only the last is kept. Returns the number of neighbours.
+// --------------------------------------------------------------------------
+int CompressedGraph::encodeNode(std::vector<Edge>::const_iterator first,
+	std::vector<Edge>::const_iterator last, const bool& weighted,
+	std::vector<uint32_t>& values, std::vector<uint8_t>& out)
+{
+	int previous = 0, count = 0;
+
+	values.clear();
+
+	for (; first != last; ++first)
+	{
+		if (first + 1 != last && (first + 1)->destination == first->destination)
+		{
+			continue; // a later copy of this edge wins
+		}
+
+		values.push_back(static_cast<uint32_t>(first->destination - previous));
+		previous = first->destination;
+
+		if (weighted)
+		{
+			values.push_back(static_cast<uint32_t>(first->weight));
+		}
+
+		count++;
+	}
+
+	encodeGroups(values, out);
+	return count;
+}
+
+// ----------------------encodeGroups()--------------------------------------
+// --Helper function that appends values to out in groups of four: a tag
+//   byte holding each value's length less one in two bits, then each value
+//   in that many little-endian bytes. The last group may be short.
+// --------------------------------------------------------------------------
+void CompressedGraph::encodeGroups(const std::vector<uint32_t>& values, std::vector<uint8_t>& out)
+{
+	for (size_t first = 0; first < values.size(); first += 4)
+	{
+		size_t tagAt = out.size();
+		uint8_t tag = 0;
+
+		out.push_back(0);
+
+		for (size_t i = 0; i < 4 && first + i < values.size(); i++)
+		{
+			uint32_t value = values[first + i];
+			int length = 1;
+
+			while (length < 4 && (value >> (8 * length)) != 0)
+			{
+				length++;
+			}
+
+			tag |= static_cast<uint8_t>((length - 1) << (2 * i));
+
+			for (int b = 0; b < length; b++)
+			{
+				out.push_back(static_cast<uint8_t>(value >> (8 * b)));
+			}
+		}
+
+		out[tagAt] = tag;
+	}
+}
+
+// ----------------------getSize()-------------------------------------------
+// --Returns the number of nodes.
+// --------------------------------------------------------------------------
+int CompressedGraph::getSize() const
+{
+	return size;
+}
+
+// ----------------------getEdgeCount()--------------------------------------
+// --Returns the number of edges, not counting repeats.
+// --------------------------------------------------------------------------
+long long CompressedGraph::getEdgeCount() const
+{
+	return edgeCount;
+}
+
+// ----------------------isWeighted()----------------------------------------
+// --Returns true if edge weights are stored.
+// --------------------------------------------------------------------------
+bool CompressedGraph::isWeighted() const
+{
+	return weighted;
+}
+
+// ----------------------getByteSize()---------------------------------------
+// --Returns the memory (or file space) used by the packed edges, offsets
+//   and degrees.
+// --------------------------------------------------------------------------
+size_t CompressedGraph::getByteSize() const
+{
+	return static_cast<size_t>(byteCount) +
+		(size + 2) * (sizeof(uint64_t) + sizeof(uint32_t));
+}
+
+// ----------------------------save()----------------------------------------
+// --Writes the graph to a file at path that load() can map. Returns false
+//   if the file could not be written.
+// --------------------------------------------------------------------------
+bool CompressedGraph::save(const std::string& path) const
+{
+	std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+	FileHeader header = FileHeader();
+
+	std::copy(FILE_MAGIC, FILE_MAGIC + 8, header.magic);
+	header.size = static_cast<uint32_t>(size);
+	header.weighted = weighted ? 1 : 0;
+	header.edgeCount = static_cast<uint64_t>(edgeCount);
+	header.byteCount = byteCount;
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(bytes), static_cast<std::streamsize>(byteCount));
+
+	return writeTail(file, header, offset, degree);
+}
+
+// ----------------------------load()----------------------------------------
+// --Maps the graph file at path and uses it as this graph's storage. Pages
+//   of edges are read from disk only as they are decoded. Returns false,
+//   leaving the graph unchanged, if the file is missing or not a graph
+//   file.
+// --Checks the whole file once before using it: the offsets never decrease
+//   and stay within the packed bytes, and every node decodes within its
+//   own bytes to neighbours 1 to size and weights no larger than INT_MAX
+//   (see checkNode()). A Cursor over a loaded graph then needs no checks.
+// --------------------------------------------------------------------------
+bool CompressedGraph::load(const std::string& path)
+{
+	std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+	FileHeader header;
+
+	if (!file->open(path) || file->getSize() < sizeof(header))
+	{
+		return false;
+	}
+
+	std::copy(file->getData(), file->getData() + sizeof(header),
+		reinterpret_cast<unsigned char*>(&header));
+
+	uint64_t nodes = static_cast<uint64_t>(header.size) + 2;
+	uint64_t fileSize = file->getSize();
+
+	// compared by subtracting and dividing, so a corrupt header cannot overflow
+	if (!std::equal(FILE_MAGIC, FILE_MAGIC + 8, header.magic) ||
+		header.size >= INT_MAX ||
+		header.byteCount > fileSize - sizeof(header) ||
+		header.offsetAt < sizeof(header) + header.byteCount ||
+		header.offsetAt > fileSize || header.offsetAt % sizeof(uint64_t) != 0 ||
+		(fileSize - header.offsetAt) / sizeof(uint64_t) < nodes ||
+		header.degreeAt < header.offsetAt + nodes * sizeof(uint64_t) ||
+		header.degreeAt > fileSize || header.degreeAt % sizeof(uint32_t) != 0 ||
+		(fileSize - header.degreeAt) / sizeof(uint32_t) < nodes)
+	{
+		return false; // not a graph file, or cut short
+	}
+
+	const uint64_t* offsets = reinterpret_cast<const uint64_t*>(file->getData() + header.offsetAt);
+	const uint32_t* degrees = reinterpret_cast<const uint32_t*>(file->getData() + header.degreeAt);
+
+	const uint8_t* packed = file->getData() + sizeof(header);
+
+	for (uint64_t v = 0; v + 1 < nodes; v++)
+	{
+		if (offsets[v] > offsets[v + 1] || offsets[v + 1] > header.byteCount ||
+			!checkNode(packed + offsets[v], packed + offsets[v + 1], degrees[v],
+				header.size, header.weighted != 0))
+		{
+			return false; // node bytes out of order, past the mapping or corrupt
+		}
+	}
+
+	size = static_cast<int>(header.size);
+	weighted = header.weighted != 0;
+	edgeCount = static_cast<long long>(header.edgeCount);
+	bytes = packed;
+	offset = offsets;
+	degree = degrees;
+	byteCount = header.byteCount;
+	owned.reset();
+	mapping = file;
+	return true;
+}
+
+// ----------------------------checkNode()-----------------------------------
+// --Helper function for load() that decodes the degree neighbours packed
+//   in first to last the way a Cursor would. Returns false if decoding
+//   would read past last, or if a neighbour is outside 1 to size or a
+//   weight is larger than INT_MAX.
+// --------------------------------------------------------------------------
+bool CompressedGraph::checkNode(const uint8_t* first, const uint8_t* last,
+	const uint32_t& degree, const uint32_t& size, const bool& weighted)
+{
+	uint64_t values = static_cast<uint64_t>(degree) * (weighted ? 2 : 1);
+	uint64_t neighbour = 0;
+	bool isGap = true;
+
+	if (degree > size)
+	{
+		return false;
+	}
+
+	for (uint64_t read = 0; read < values; read += 4)
+	{
+		int count = values - read < 4 ? static_cast<int>(values - read) : 4;
+
+		if (first == last)
+		{
+			return false;
+		}
+
+		uint8_t tag = *first++;
+
+		for (int i = 0; i < count; i++)
+		{
+			int length = ((tag >> (2 * i)) & 3) + 1;
+			uint32_t value = 0;
+
+			if (last - first < length)
+			{
+				return false;
+			}
+
+			for (int b = 0; b < length; b++) // little endian
+			{
+				value |= static_cast<uint32_t>(first[b]) << (8 * b);
+			}
+
+			first += length;
+
+			if (isGap)
+			{
+				neighbour += value;
+
+				if (neighbour == 0 || neighbour > size)
+				{
+					return false;
+				}
+			}
+			else if (value > static_cast<uint32_t>(INT_MAX))
+			{
+				return false;
+			}
+
+			isGap = !weighted || !isGap;
+		}
+	}
+
+	return true;
+}
+
+// ----------------------------writeTail()-----------------------------------
+// --Helper function for save() and Writer. With the header and packed
+//   bytes already written to file, pads to 8 bytes, writes the offsets and
+//   degrees, and rewrites the header with their positions.
+// --------------------------------------------------------------------------
+bool CompressedGraph::writeTail(std::ofstream& file, FileHeader header,
+	const uint64_t* offset, const uint32_t* degree)
+{
+	static const char zeros[8] = { 0 };
+	uint64_t nodes = static_cast<uint64_t>(header.size) + 2;
+	uint64_t position = sizeof(header) + header.byteCount;
+	uint64_t padding = (8 - position % 8) % 8;
+
+	file.write(zeros, static_cast<std::streamsize>(padding));
+	position += padding;
+
+	header.offsetAt = position;
+	file.write(reinterpret_cast<const char*>(offset),
+		static_cast<std::streamsize>(nodes * sizeof(uint64_t)));
+	position += nodes * sizeof(uint64_t);
+
+	header.degreeAt = position;
+	file.write(reinterpret_cast<const char*>(degree),
+		static_cast<std::streamsize>(nodes * sizeof(uint32_t)));
+
+	file.seekp(0);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.flush();
+	return file.good();
+}
+
+// ----------------------hasEdge()-------------------------------------------
+// --Returns true if there is an edge from source to destination. Decodes
+//   the neighbours of source until it passes destination.
+// --------------------------------------------------------------------------
+bool CompressedGraph::hasEdge(const int& source, const int& destination) const
+{
+	if (source <= 0 || source > size || destination <= 0 || destination > size)
+	{
+		return false;
+	}
+
+	Cursor cursor(*this, source);
+	int neighbour = 0, weight = 0;
+
+	while (cursor.next(neighbour, weight) && neighbour <= destination)
+	{
+		if (neighbour == destination)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// ---------------------depthFirstSearch()-----------------------------------
+// --Makes a depth-first search and prints each node in depth-first order
+//   to out, in the same format as GraphL.
+// --Uses workspace's frontier as an explicit stack instead of recursion so
+//   that long paths cannot overflow the call stack. A node's neighbours are
+//   pushed in reverse and a node is marked when popped, which visits nodes
+//   in the same order as the recursive search.
+// --------------------------------------------------------------------------
+void CompressedGraph::depthFirstSearch(std::ostream& out, QueryWorkspace& workspace) const
+{
+	std::vector<int>& stack = workspace.getFrontier();
+	int neighbour = 0, weight = 0;
+
+	workspace.begin(size + 1); // resets visits
+
+	if (mapping) // a whole-graph walk reads the bytes mostly front to back
+	{
+		mapping->adviseSequential(static_cast<size_t>(bytes - mapping->getData()), byteCount);
+	}
+
+	out << std::endl << "Depth-first ordering: ";
+
+	for (int start = 1; start <= size; start++)
+	{
+		if (workspace.isVisited(start))
+		{
+			continue;
+		}
+
+		stack.push_back(start);
+
+		while (!stack.empty())
+		{
+			int v = stack.back();
+			stack.pop_back();
+
+			if (workspace.isVisited(v))
+			{
+				continue;
+			}
+
+			workspace.markVisited(v);
+			out << v << ' ';
+
+			size_t pushed = stack.size();
+			Cursor cursor(*this, v);
+
+			while (cursor.next(neighbour, weight))
+			{
+				if (!workspace.isVisited(neighbour))
+				{
+					stack.push_back(neighbour);
+				}
+			}
+
+			std::reverse(stack.begin() + pushed, stack.end()); // lowest on top
+		}
+	}
+
+	out << std::endl << std::endl;
+}
+
+// --------------------breadthFirstSearch()----------------------------------
+// --Prints every node reachable from source in breadth-first order to out.
+//   Uses workspace's frontier as the queue.
+// --------------------------------------------------------------------------
+void CompressedGraph::breadthFirstSearch(const int& source, std::ostream& out,
+	QueryWorkspace& workspace) const
+{
+	std::vector<int>& queue = workspace.getFrontier();
+	int neighbour = 0, weight = 0;
+
+	workspace.begin(size + 1);
+
+	out << std::endl << "Breadth-first ordering: ";
+
+	if (source > 0 && source <= size)
+	{
+		workspace.markVisited(source);
+		queue.push_back(source);
+	}
+
+	for (size_t head = 0; head < queue.size(); head++)
+	{
+		Cursor cursor(*this, queue[head]);
+		out << queue[head] << ' ';
+
+		while (cursor.next(neighbour, weight))
+		{
+			if (!workspace.isVisited(neighbour))
+			{
+				workspace.markVisited(neighbour);
+				queue.push_back(neighbour);
+			}
+		}
+	}
+
+	out << std::endl << std::endl;
+}
+
+// -----------------------shortestPath()-------------------------------------
+// --Finds the shortest path from source to every node with Dijkstra's
+//   algorithm. Afterwards workspace.getDist(v) and workspace.getParent(v)
+//   give the distance and previous node for every v, INT_MAX and 0 when v
+//   is unreachable, or only by a path whose length would reach INT_MAX.
+//   Ties go to the lowest numbered node, as in GraphM.
+// --------------------------------------------------------------------------
+void CompressedGraph::shortestPath(const int& source, QueryWorkspace& workspace) const
+{
+	int neighbour = 0, weight = 0;
+
+	workspace.begin(size + 1);
+
+	if (source <= 0 || source > size)
+	{
+		return;
+	}
+
+	workspace.setDist(source, 0, 0);
+	workspace.pushHeap(0, source);
+
+	while (!workspace.heapEmpty())
+	{
+		std::pair<int, int> top = workspace.popHeap();
+		int v = top.second;
+
+		if (workspace.isVisited(v)) // left behind by a later improvement
+		{
+			continue;
+		}
+
+		workspace.markVisited(v);
+		Cursor cursor(*this, v);
+
+		while (cursor.next(neighbour, weight))
+		{
+			if (!workspace.isVisited(neighbour))
+			{
+				long long distance = static_cast<long long>(top.first) + weight;
+
+				if (distance < INT_MAX && workspace.getDist(neighbour) > distance)
+				{
+					workspace.setDist(neighbour, static_cast<int>(distance), v);
+					workspace.pushHeap(static_cast<int>(distance), neighbour);
+				}
+			}
+		}
+	}
+}
+
+// -----------------------Cursor Constructor---------------------------------
+// --Positions the cursor before the first neighbour of vertex.
+// --------------------------------------------------------------------------
+CompressedGraph::Cursor::Cursor(const CompressedGraph& graph, const int& vertex)
+	: position(graph.bytes + graph.offset[vertex]),
+	  remaining(graph.degree[vertex] * (graph.weighted ? 2 : 1)),
+	  groupIndex(0), groupCount(0), previous(0), weighted(graph.weighted)
+{
+}
+
+// -----------------------Writer Constructor---------------------------------
+// --Constructs a writer without a file.
+// --------------------------------------------------------------------------
+CompressedGraph::Writer::Writer()
+	: size(0), weighted(false), nextNode(0), edgeCount(0), byteCount(0)
+{
+}
+
+// -----------------------Writer open()--------------------------------------
+// --Starts a graph file of size nodes at path. Returns false if the file
+//   cannot be created.
+// --------------------------------------------------------------------------
+bool CompressedGraph::Writer::open(const std::string& path, const int& size, const bool& weighted)
+{
+	FileHeader header = FileHeader();
+
+	this->size = size > 0 ? size : 0;
+	this->weighted = weighted;
+	nextNode = 0;
+	edgeCount = 0;
+	byteCount = 0;
+	offset.assign(this->size + 2, 0);
+	degree.assign(this->size + 2, 0);
+
+	file.open(path.c_str(), std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header)); // filled in by close()
+	return file.good();
+}
+
+// -----------------------Writer addNode()-----------------------------------
+// --Writes the edges of source, which must come after every node written
+//   so far. Nodes that are skipped get no edges. edges is sorted in place.
+//   Returns false, writing nothing, if source is out of order or out of
+//   range, or if any edge does not start at source, ends outside 1 to
+//   size, or has a negative weight.
+// --------------------------------------------------------------------------
+bool CompressedGraph::Writer::addNode(const int& source, std::vector<Edge>& edges)
+{
+	if (source <= 0 || source < nextNode || source > size)
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < edges.size(); i++)
+	{
+		if (edges[i].source != source || !isValidEdge(edges[i], size, weighted))
+		{
+			return false;
+		}
+	}
+
+	std::stable_sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b)
+	{
+		return a.destination < b.destination;
+	});
+
+	for (; nextNode < source; nextNode++) // nodes without edges
+	{
+		offset[nextNode] = byteCount;
+	}
+
+	packed.clear();
+	offset[source] = byteCount;
+	degree[source] = encodeNode(edges.begin(), edges.end(), weighted, values, packed);
+	edgeCount += degree[source];
+	byteCount += packed.size();
+	nextNode = source + 1;
+
+	file.write(reinterpret_cast<const char*>(packed.data()), static_cast<std::streamsize>(packed.size()));
+	return file.good();
+}
+
+// -----------------------Writer close()-------------------------------------
+// --Finishes the file so load() can map it. Returns false if anything
+//   failed to write.
+// --------------------------------------------------------------------------
+bool CompressedGraph::Writer::close()
+{
+	FileHeader header = FileHeader();
+
+	for (; nextNode <= size + 1; nextNode++) // nodes without edges
+	{
+		offset[nextNode] = byteCount;
+	}
+
+	std::copy(FILE_MAGIC, FILE_MAGIC + 8, header.magic);
+	header.size = static_cast<uint32_t>(size);
+	header.weighted = weighted ? 1 : 0;
+	header.edgeCount = static_cast<uint64_t>(edgeCount);
+	header.byteCount = byteCount;
+
+	bool written = writeTail(file, header, offset.data(), degree.data());
+	file.close();
+	return written;
+}
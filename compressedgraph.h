@@ -0,0 +1,232 @@
+// -------------------- compressedgraph.h ---------------------------------
+//
+// Ethan Thomas
+// ------------------------------------------------------------------------
+// --Purpose: A read-only adjacency format for graphs too large to hold as
+//   GraphL edge lists or a GraphM matrix. Each node's neighbours are sorted
+//   and stored as gaps from the previous neighbour. The gaps (and the
+//   weights, if any) are packed with group varint encoding: one tag byte
+//   gives the byte length of the next four values, then the values follow
+//   in 1 to 4 bytes each. A per-node offset finds the start of each node's
+//   bytes. Most edges of a graph numbered with locality (see
+//   vertexorder.h) take 1 to 2 bytes.
+// --Depth-first search, breadth-first search and single-source shortest
+//   paths run directly on the packed bytes, decoding one group at a time.
+// --A graph can be saved to a file and loaded back memory-mapped, so the
+//   operating system pages edges in as traversals reach them and a graph
+//   larger than memory can still be searched. Writer builds such a file
+//   one node at a time without holding the edges in memory.
+// ------------------------------------------------------------------------
+// Assumptions:
+// --Nodes are numbered 1 to size; 0 is unused, as in GraphL and GraphM.
+//   There is no MAXNODES limit.
+// --The constructor drops edges whose nodes are outside 1 to size or, for
+//   a weighted graph, whose weight is negative; Writer::addNode() refuses
+//   them. A repeated edge is kept once, with the weight it was given last,
+//   the way GraphM::insertEdge() overwrites a cost.
+// --Neighbours are visited in ascending order, so depthFirstSearch() can
+//   order nodes differently from GraphL, which follows insertion order.
+// --An unweighted graph behaves as if every edge had weight 1.
+// --Group varint is decoded here one value at a time. The layout keeps the
+//   lengths of four values in one tag byte so that a vectorized decoder can
+//   unpack a whole group with one shuffle.
+// --Files hold the packed bytes, then the offsets, then the degrees, in
+//   the byte order of the machine that wrote them.
+// --Copies of a CompressedGraph share its (read-only) storage. A moved-from
+//   graph is left empty.
+// ------------------------------------------------------------------------
+
+#ifndef COMPRESSEDGRAPH_H
+#define COMPRESSEDGRAPH_H
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <string>
+#include <fstream>
+#include <memory>
+#include "queryworkspace.h"
+#include "mappedfile.h"
+
+
+class CompressedGraph
+{
+
+public:
+	struct Edge
+	{
+		int source;
+		int destination;
+		int weight;                     // ignored for an unweighted graph
+	};
+
+	// --------------------------- Cursor -----------------------------------
+	// --Walks one node's neighbours in ascending order, decoding as it goes.
+	// ----------------------------------------------------------------------
+	class Cursor
+	{
+	public:
+		Cursor(const CompressedGraph& graph, const int& vertex);
+
+		bool next(int& neighbour, int& weight);
+
+	private:
+		uint32_t nextValue();
+
+		const uint8_t* position;        // next unread byte
+		uint32_t remaining;             // values left to decode for this node
+		uint32_t group[4];              // the group being read
+		int groupIndex;                 // next value to hand out from group
+		int groupCount;                 // values decoded into group
+		int previous;                   // last neighbour returned
+		bool weighted;                  // values alternate gap, weight
+	};
+
+	// --------------------------- Writer -----------------------------------
+	// --Writes a graph file node by node, holding only the offsets and
+	//   degrees in memory.
+	// ----------------------------------------------------------------------
+	class Writer
+	{
+	public:
+		Writer();
+
+		bool open(const std::string& path, const int& size, const bool& weighted);
+		bool addNode(const int& source, std::vector<Edge>& edges);
+		bool close();
+
+	private:
+		std::ofstream file;             // graph file being written
+		int size;                       // number of nodes
+		bool weighted;                  // whether weights are stored
+		int nextNode;                   // lowest node not yet written
+		long long edgeCount;            // edges written so far
+		uint64_t byteCount;             // packed bytes written so far
+		std::vector<uint64_t> offset;   // as in CompressedGraph
+		std::vector<uint32_t> degree;   // as in CompressedGraph
+		std::vector<uint8_t> packed;    // bytes of the node being written
+		std::vector<uint32_t> values;   // values of the node being written
+	};
+
+	CompressedGraph();
+	CompressedGraph(const int& size, std::vector<Edge> edges, const bool& weighted);
+	CompressedGraph(const CompressedGraph& other) = default;
+	CompressedGraph(CompressedGraph&& other) noexcept;
+
+	CompressedGraph& operator=(const CompressedGraph& rhs) = default;
+	CompressedGraph& operator=(CompressedGraph&& rhs) noexcept;
+
+	bool save(const std::string& path) const;
+	bool load(const std::string& path);
+
+	int getSize() const;
+	long long getEdgeCount() const;
+	bool isWeighted() const;
+	size_t getByteSize() const;
+
+	bool hasEdge(const int& source, const int& destination) const;
+
+	void depthFirstSearch(std::ostream& out, QueryWorkspace& workspace) const;
+	void breadthFirstSearch(const int& source, std::ostream& out, QueryWorkspace& workspace) const;
+	void shortestPath(const int& source, QueryWorkspace& workspace) const;
+
+
+
+private:
+
+	struct FileHeader
+	{
+		char magic[8];                  // FILE_MAGIC
+		uint32_t size;
+		uint32_t weighted;
+		uint64_t edgeCount;
+		uint64_t byteCount;             // packed bytes, which follow the header
+		uint64_t offsetAt;              // file position of the offsets
+		uint64_t degreeAt;              // file position of the degrees
+	};
+
+	struct Buffers
+	{
+		std::vector<uint64_t> offset;
+		std::vector<uint32_t> degree;
+		std::vector<uint8_t> bytes;
+	};
+
+	static const char FILE_MAGIC[8];
+
+	static bool isValidEdge(const Edge& edge, const int& size, const bool& weighted);
+	static int encodeNode(std::vector<Edge>::const_iterator first,
+		std::vector<Edge>::const_iterator last, const bool& weighted,
+		std::vector<uint32_t>& values, std::vector<uint8_t>& out);
+	static void encodeGroups(const std::vector<uint32_t>& values, std::vector<uint8_t>& out);
+	static bool checkNode(const uint8_t* first, const uint8_t* last, const uint32_t& degree,
+		const uint32_t& size, const bool& weighted);
+	static bool writeTail(std::ofstream& file, FileHeader header,
+		const uint64_t* offset, const uint32_t* degree);
+
+	static const std::shared_ptr<const Buffers>& emptyBuffers();
+
+	void makeEmpty();
+	void pointAt(const std::shared_ptr<const Buffers>& buffers);
+
+	int size;                                  // number of nodes
+	bool weighted;                             // whether weights are stored
+	long long edgeCount;                       // edges after removing repeats
+	std::shared_ptr<const Buffers> owned;      // storage when built in memory
+	std::shared_ptr<const MappedFile> mapping; // storage when loaded from a file
+	const uint64_t* offset;                    // bytes of node v start at bytes[offset[v]]
+	const uint32_t* degree;                    // number of neighbours of node v
+	const uint8_t* bytes;                      // packed groups of every node, in node order
+	uint64_t byteCount;                        // length of bytes
+
+
+};
+
+// ----------------------Cursor::next()--------------------------------------
+// --Sets neighbour (and weight, 1 if unweighted) to the next neighbour of
+//   the node. Returns false once every neighbour has been returned.
+// --------------------------------------------------------------------------
+inline bool CompressedGraph::Cursor::next(int& neighbour, int& weight)
+{
+	if (remaining == 0 && groupIndex == groupCount) // no neighbours left
+	{
+		return false;
+	}
+
+	previous += static_cast<int>(nextValue());
+	neighbour = previous;
+	weight = weighted ? static_cast<int>(nextValue()) : 1;
+	return true;
+}
+
+// ----------------------Cursor::nextValue()---------------------------------
+// --Returns the next packed value, decoding a new group when the current
+//   one is used up.
+// --------------------------------------------------------------------------
+inline uint32_t CompressedGraph::Cursor::nextValue()
+{
+	if (groupIndex == groupCount)
+	{
+		uint8_t tag = *position++;
+		groupCount = remaining < 4 ? static_cast<int>(remaining) : 4;
+		groupIndex = 0;
+		remaining -= groupCount;
+
+		for (int i = 0; i < groupCount; i++)
+		{
+			int length = ((tag >> (2 * i)) & 3) + 1;
+			uint32_t value = 0;
+
+			for (int b = 0; b < length; b++) // little endian
+			{
+				value |= static_cast<uint32_t>(position[b]) << (8 * b);
+			}
+
+			group[i] = value;
+			position += length;
+		}
+	}
+
+	return group[groupIndex++];
+}
+
+#endif // !COMPRESSEDGRAPH_H
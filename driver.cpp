@@ -10,17 +10,385 @@
 //   -- text files "data31.txt" and "data32.txt" are formatted as described 
 //   -- Data file data3uwb provides an additional data set for part 1;
 //      it must be edited, as it starts with a description how to use it
+//
+// Batch mode:
+//   a.out --batch m|l <file> [workers]
+//   runs part 1 (m) or part 2 (l) on every graph in <file> through a
+//   parse -> solve/format -> write pipeline (see batchpipeline.h). Output
+//   is identical to the sequential loops below. workers defaults to the
+//   number of hardware threads.
+//
+// Server mode:
+//   a.out --serve <file> [socket path]
+//   reads the first graph of <file> for part 1, finds its shortest paths
+//   once and answers dist/path/reach/insert/remove requests (see
+//   queryserver.h) from stdin, or from clients of a Unix socket at
+//   [socket path], until told to quit.
+//
+// Out-of-core mode:
+//   a.out --apsp <file> <result file>
+//   streams the edges of the first graph of <file> for part 1, which must
+//   be listed by ascending source, into a packed graph file
+//   <result file>.graph without building a GraphM. It then maps that file,
+//   writes every shortest path to <result file> one source at a time (see
+//   externalpaths.h) and displays the same paths as part 1 from it.
+//
+// Check mode:
+//   a.out --check <part 1 file> <part 2 file>
+//   compares answers that must agree: CompressedGraph::shortestPath()
+//   against GraphM, GraphMVersions against a GraphM given the same edge
+//   changes, GraphL with each VertexOrder against GraphL unrelabeled, and
+//   hasEdge() of GraphL against its CompressedGraph before and after a
+//   save() and load(). Prints each mismatch and returns 1 if there was any.
+//
+// Tracing:
+//   a.out --trace <json file> [other arguments]
+//   runs as above and then writes a timeline of buildGraph(),
+//   findShortestPath() per source, displayAll() and depthFirstSearch() on
+//   every thread to <json file> in Chrome trace format (see trace.h).
 //---------------------------------------------------------------------------
 
 #include <iostream>
 #include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <sstream>
+#include <random>
+#include <cstdio>
 #include "graphl.h"
 #include "graphm.h"
+#include "batchpipeline.h"
+#include "trace.h"
+#include "queryserver.h"
+#include "externalpaths.h"
+#include "graphmversions.h"
 using namespace std;
 
-int main()
+//------------------------------ processM -----------------------------------
+// part 1 for one graph: solve, then display everything the loop below does
+void processM(GraphM& G, ostream& out)
+{
+	G.findShortestPath();
+	G.displayAll(out);
+	G.display(3, 1, out);
+	G.display(1, 2, out);
+	G.display(1, 4, out);
+}
+
+//------------------------------ processL -----------------------------------
+// part 2 for one graph: display it and its depth-first ordering
+void processL(GraphL& G, ostream& out)
+{
+	G.displayGraph(out);
+	G.depthFirstSearch(out, QueryWorkspace::local());
+}
+
+//------------------------------ runBatchMode -------------------------------
+// handles "a.out --batch m|l <file> [workers]"
+int runBatchMode(int argc, char* argv[])
+{
+	if (argc < 4 || (strcmp(argv[2], "m") != 0 && strcmp(argv[2], "l") != 0)) {
+		cout << "Usage: " << argv[0] << " --batch m|l <file> [workers]" << endl;
+		return 1;
+	}
+
+	ifstream infile(argv[3]);
+	if (!infile) {
+		cout << "File could not be opened." << endl;
+		return 1;
+	}
+
+	int workers = (argc > 4) ? atoi(argv[4]) : (int)thread::hardware_concurrency();
+
+	ios::sync_with_stdio(false);   // only the writer stage touches cout
+
+	if (strcmp(argv[2], "m") == 0)
+		runBatch<GraphM>(infile, cout, workers, processM);
+	else
+		runBatch<GraphL>(infile, cout, workers, processL);
+
+	cout << endl;
+	return 0;
+}
+
+//------------------------------ runServeMode -------------------------------
+// handles "a.out --serve <file> [socket path]"
+int runServeMode(int argc, char* argv[])
+{
+	if (argc < 3) {
+		cerr << "Usage: " << argv[0] << " --serve <file> [socket path]" << endl;
+		return 1;
+	}
+
+	ifstream infile(argv[2]);
+	if (!infile) {
+		cerr << "File could not be opened." << endl;
+		return 1;
+	}
+
+	GraphM G;
+	G.buildGraph(infile, cerr);    // cout may be carrying answers
+	if (G.getSize() == 0) {
+		cerr << "Graph could not be read." << endl;
+		return 1;
+	}
+
+	QueryServer server(std::move(G));
+
+	if (argc > 3) {
+		if (!server.listen(argv[3])) {
+			cerr << "Socket could not be opened." << endl;
+			return 1;
+		}
+	}
+	else {
+		server.serve(0, 1);        // stdin, stdout
+	}
+
+	return 0;
+}
+
+//------------------------------ runApspMode --------------------------------
+// handles "a.out --apsp <file> <result file>"
+int runApspMode(int argc, char* argv[])
 {
+	if (argc < 4) {
+		cerr << "Usage: " << argv[0] << " --apsp <file> <result file>" << endl;
+		return 1;
+	}
+
+	ifstream infile(argv[2]);
+	if (!infile) {
+		cerr << "File could not be opened." << endl;
+		return 1;
+	}
 
+	string resultPath = argv[3];
+	string graphPath = resultPath + ".graph";
+	int size = 0;
+	infile >> size;
+	if (size <= 0) {
+		cerr << "Graph could not be read." << endl;
+		return 1;
+	}
+
+	string description;
+	getline(infile, description);          // rest of the size line
+	for (int i = 1; i <= size; i++)         // node descriptions are not kept
+		getline(infile, description);
+
+	CompressedGraph::Writer writer;
+	if (!writer.open(graphPath, size, true)) {
+		cerr << "Graph file could not be written." << endl;
+		return 1;
+	}
+
+	// edges of one source at a time, so only one node's edges are in memory
+	vector<CompressedGraph::Edge> edges;
+	CompressedGraph::Edge edge = { 0, 0, 0 };
+	bool more = true;
+
+	while (more) {
+		more = (infile >> edge.source >> edge.destination >> edge.weight) && edge.source != 0;
+
+		if (!edges.empty() && (!more || edge.source != edges[0].source)) {
+			if (!writer.addNode(edges[0].source, edges)) {
+				cerr << "Edges of node " << edges[0].source
+					<< " are out of order or out of range." << endl;
+				return 1;
+			}
+			edges.clear();
+		}
+
+		if (more)
+			edges.push_back(edge);
+	}
+
+	CompressedGraph graph;
+	ExternalPaths paths;
+
+	if (!writer.close() || !graph.load(graphPath)) {
+		cerr << "Graph file could not be written." << endl;
+		return 1;
+	}
+
+	if (!ExternalPaths::solve(graph, resultPath, QueryWorkspace::local()) ||
+		!paths.open(resultPath)) {
+		cerr << "Result file could not be written." << endl;
+		return 1;
+	}
+
+	cout << graph.getSize() << " nodes, " << graph.getEdgeCount() << " edges in "
+		<< graph.getByteSize() << " bytes" << endl;
+	paths.display(3, 1, cout);
+	paths.display(1, 2, cout);
+	paths.display(1, 4, cout);
+	return 0;
+}
+
+//------------------------------ checkPaths ---------------------------------
+// CompressedGraph::shortestPath() against GraphM's distances, and
+// GraphMVersions against a GraphM given the same random edge changes;
+// returns the number of mismatches
+int checkPaths(GraphM& G, mt19937& random)
+{
+	int mismatches = 0;
+	int size = G.getSize();
+	QueryWorkspace& workspace = QueryWorkspace::local();
+
+	G.findShortestPath();
+	CompressedGraph packed = G.compress();
+
+	for (int s = 1; s <= size; s++) {
+		packed.shortestPath(s, workspace);
+		for (int d = 1; d <= size; d++) {
+			if (workspace.getDist(d) != G.getDist(s, d)) {
+				cout << "compressed distance " << s << " -> " << d << ": "
+					<< workspace.getDist(d) << ", GraphM: " << G.getDist(s, d) << endl;
+				mismatches++;
+			}
+		}
+	}
+
+	GraphMVersions versions;
+	versions.publish(G);
+
+	for (int change = 0; change < 2 * size; change++) {
+		int s = 1 + (int)(random() % size);
+		int d = 1 + (int)(random() % size);
+
+		if (random() % 4 == 0) {
+			versions.removeEdge(s, d);
+			G.removeEdge(s, d);
+		}
+		else {
+			int cost = 1 + (int)(random() % 100);
+			versions.insertEdge(s, d, cost);
+			G.insertEdge(s, d, cost);
+		}
+
+		GraphMVersions::ReadGuard version = versions.read();
+		for (int v = 1; v <= size; v++) {
+			for (int w = 1; w <= size; w++) {
+				if (version->getDist(v, w) != G.getDist(v, w)) {
+					cout << "version " << versions.getVersion() << " distance " << v
+						<< " -> " << w << ": " << version->getDist(v, w)
+						<< ", GraphM: " << G.getDist(v, w) << endl;
+					mismatches++;
+				}
+			}
+		}
+	}
+
+	return mismatches;
+}
+
+//------------------------------ checkEdges ---------------------------------
+// GraphL output with each VertexOrder against no relabeling, and hasEdge()
+// against its CompressedGraph before and after a save() and load();
+// returns the number of mismatches
+int checkEdges(GraphL& G, const string& scratchPath)
+{
+	int mismatches = 0;
+	QueryWorkspace& workspace = QueryWorkspace::local();
+	ostringstream expected;
+	processL(G, expected);
+
+	const VertexOrder orders[] = { ORDER_BFS, ORDER_RCM, ORDER_DEGREE };
+	for (size_t i = 0; i < sizeof(orders) / sizeof(orders[0]); i++) {
+		GraphL relabeled(G);
+		ostringstream found;
+		relabeled.relabel(orders[i]);
+		processL(relabeled, found);
+
+		if (found.str() != expected.str()) {
+			cout << "relabeled output differs with order " << orders[i] << endl;
+			mismatches++;
+		}
+	}
+
+	CompressedGraph packed = G.compress();
+	CompressedGraph loaded;
+	ostringstream packedOrder, loadedOrder;
+	int size = packed.getSize();
+
+	if (!packed.save(scratchPath) || !loaded.load(scratchPath)) {
+		cout << "compressed graph could not be saved and loaded" << endl;
+		return mismatches + 1;
+	}
+
+	packed.depthFirstSearch(packedOrder, workspace);
+	loaded.depthFirstSearch(loadedOrder, workspace);
+	if (packedOrder.str() != loadedOrder.str() ||
+		packed.getEdgeCount() != loaded.getEdgeCount()) {
+		cout << "loaded compressed graph differs from the saved one" << endl;
+		mismatches++;
+	}
+
+	for (int s = 1; s <= size; s++) {
+		for (int d = 1; d <= size; d++) {
+			bool edge = G.hasEdge(s, d);
+			if (packed.hasEdge(s, d) != edge || loaded.hasEdge(s, d) != edge) {
+				cout << "hasEdge " << s << " -> " << d << ": GraphL " << edge
+					<< ", compressed " << packed.hasEdge(s, d)
+					<< ", loaded " << loaded.hasEdge(s, d) << endl;
+				mismatches++;
+			}
+		}
+	}
+
+	return mismatches;
+}
+
+//------------------------------ runCheckMode -------------------------------
+// handles "a.out --check <part 1 file> <part 2 file>"
+int runCheckMode(int argc, char* argv[])
+{
+	if (argc < 4) {
+		cout << "Usage: " << argv[0] << " --check <part 1 file> <part 2 file>" << endl;
+		return 1;
+	}
+
+	ifstream infile1(argv[2]);
+	ifstream infile2(argv[3]);
+	if (!infile1 || !infile2) {
+		cout << "File could not be opened." << endl;
+		return 1;
+	}
+
+	mt19937 random(343);           // the same changes on every run
+	string scratchPath = string(argv[3]) + ".check";
+	ostringstream errors;          // bad edges are not what is checked
+	int graphs = 0, mismatches = 0;
+
+	for (;;) {
+		GraphM G;
+		G.buildGraph(infile1, errors);
+		if (infile1.eof())
+			break;
+		mismatches += checkPaths(G, random);
+		graphs++;
+	}
+
+	for (;;) {
+		GraphL G;
+		G.buildGraph(infile2, errors);
+		if (infile2.eof())
+			break;
+		mismatches += checkEdges(G, scratchPath);
+		graphs++;
+	}
+
+	remove(scratchPath.c_str());
+	cout << graphs << " graphs checked, " << mismatches << " mismatches" << endl;
+	return mismatches == 0 ? 0 : 1;
+}
+
+//------------------------------ runLab ------------------------------------
+// parts 1 and 2 on data31.txt and data32.txt
+int runLab()
+{
 	// part 1
 	ifstream infile1("data31.txt");
 	if (!infile1) {
@@ -64,3 +432,37 @@ int main()
 	//system("pause");
 	return 0;
 }
+
+int main(int argc, char* argv[])
+{
+	const char* traceFile = nullptr;
+
+	if (argc > 2 && strcmp(argv[1], "--trace") == 0) {
+		traceFile = argv[2];
+		Trace::enable(true);
+		Trace::nameThread("main");
+		argv[2] = argv[0];          // drop "--trace <file>" from the arguments
+		argv += 2;
+		argc -= 2;
+	}
+
+	int result = 0;
+
+	if (argc > 1 && strcmp(argv[1], "--batch") == 0)
+		result = runBatchMode(argc, argv);
+	else if (argc > 1 && strcmp(argv[1], "--serve") == 0)
+		result = runServeMode(argc, argv);
+	else if (argc > 1 && strcmp(argv[1], "--apsp") == 0)
+		result = runApspMode(argc, argv);
+	else if (argc > 1 && strcmp(argv[1], "--check") == 0)
+		result = runCheckMode(argc, argv);
+	else
+		result = runLab();
+
+	if (traceFile != nullptr && !Trace::exportJson(string(traceFile))) {
+		cout << "Trace file could not be written." << endl;
+		return 1;
+	}
+
+	return result;
+}
@@ -0,0 +1,195 @@
+// --------------------- externalpaths.cpp --------------------------------
+//
+// Ethan Thomas
+//
+// --------------------------------------------------------------------------
+#include "externalpaths.h"
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <climits>
+
+const char ExternalPaths::FILE_MAGIC[8] = { 'A', 'P', 'S', 'P', 'R', 'O', 'W', '1' };
+
+const int EXTERNAL_WRITE_BUFFER = 1 << 20; //bytes buffered per write
+
+// -----------------------Default Constructor--------------------------------
+// --Constructs an object without an open result file.
+// --------------------------------------------------------------------------
+ExternalPaths::ExternalPaths()
+	: size(0), rows(nullptr)
+{
+}
+
+// ---------------------------solve()----------------------------------------
+// --Finds the shortest path between every node to every other node of
+//   graph and writes the result to a file at path, one row per source,
+//   each row written as soon as its source is done. Returns false if the
+//   file could not be written.
+// --------------------------------------------------------------------------
+bool ExternalPaths::solve(const CompressedGraph& graph, const std::string& path,
+	QueryWorkspace& workspace)
+{
+	std::vector<char> buffer(EXTERNAL_WRITE_BUFFER);
+	std::ofstream file;
+	FileHeader header = FileHeader();
+	int nodes = graph.getSize();
+	std::vector<Entry> entries(nodes + 1);
+
+	file.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+	file.open(path.c_str(), std::ios::binary | std::ios::trunc);
+
+	std::copy(FILE_MAGIC, FILE_MAGIC + 8, header.magic);
+	header.size = static_cast<uint32_t>(nodes);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	entries[0].dist = INT_MAX;
+	entries[0].path = 0;
+
+	for (int source = 1; source <= nodes && file.good(); ++source)
+	{
+		graph.shortestPath(source, workspace);
+
+		for (int w = 1; w <= nodes; ++w)
+		{
+			entries[w].dist = workspace.getDist(w);
+			entries[w].path = workspace.getParent(w);
+		}
+
+		file.write(reinterpret_cast<const char*>(entries.data()),
+			static_cast<std::streamsize>(entries.size() * sizeof(Entry)));
+	}
+
+	file.close();
+	return !file.fail();
+}
+
+// ----------------------------open()----------------------------------------
+// --Maps the result file at path. Returns false, leaving any open file
+//   open, if it is missing, not a result file, or cut short.
+// --------------------------------------------------------------------------
+bool ExternalPaths::open(const std::string& path)
+{
+	std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+	FileHeader header;
+
+	if (!file->open(path) || file->getSize() < sizeof(header))
+	{
+		return false;
+	}
+
+	std::copy(file->getData(), file->getData() + sizeof(header),
+		reinterpret_cast<unsigned char*>(&header));
+
+	uint64_t nodes = header.size;
+	uint64_t entries = (file->getSize() - sizeof(header)) / sizeof(Entry);
+
+	// divides instead of multiplying, so a corrupt size cannot overflow
+	if (!std::equal(FILE_MAGIC, FILE_MAGIC + 8, header.magic) ||
+		nodes >= INT_MAX || (nodes > 0 && entries / (nodes + 1) < nodes))
+	{
+		return false;
+	}
+
+	size = static_cast<int>(header.size);
+	rows = reinterpret_cast<const Entry*>(file->getData() + sizeof(header));
+	mapping = file;
+	return true;
+}
+
+// ---------------------------getSize()--------------------------------------
+// --Returns the number of nodes in the open result file.
+// --------------------------------------------------------------------------
+int ExternalPaths::getSize() const
+{
+	return size;
+}
+
+// ---------------------------getDist()--------------------------------------
+// --Returns the shortest distance from source to destination, or INT_MAX
+//   if there is no path or either node is out of range.
+// --------------------------------------------------------------------------
+int ExternalPaths::getDist(const int& source, const int& destination) const
+{
+	const Entry* entries = row(source);
+
+	if (entries == nullptr || destination <= 0 || destination > size)
+	{
+		return INT_MAX;
+	}
+
+	return entries[destination].dist;
+}
+
+// ---------------------------getParent()------------------------------------
+// --Returns the node before destination on the shortest path from source,
+//   or 0 if there is none.
+// --------------------------------------------------------------------------
+int ExternalPaths::getParent(const int& source, const int& destination) const
+{
+	const Entry* entries = row(source);
+
+	if (entries == nullptr || destination <= 0 || destination > size)
+	{
+		return 0;
+	}
+
+	return entries[destination].path;
+}
+
+// ---------------------------display()--------------------------------------
+// --Displays the full path and distance between 2 specified nodes to out,
+//   in the format of the first line of GraphM::display(). There are no
+//   node descriptions to print.
+// --------------------------------------------------------------------------
+void ExternalPaths::display(const int& source, const int& destination, std::ostream& out) const
+{
+	int dist = getDist(source, destination);
+
+	out.width(4);
+	out << std::right << source;
+	out.width(8);
+
+	if (dist < INT_MAX) // prints path
+	{
+		std::vector<int> path;
+
+		for (int v = getParent(source, destination); v != 0 && static_cast<int>(path.size()) < size;
+			v = getParent(source, v)) // a corrupt file cannot loop forever
+		{
+			path.push_back(v);
+		}
+
+		out << destination;
+		out.width(8);
+		out << dist;
+		out << "        ";
+
+		for (size_t i = path.size(); i > 0; i--)
+		{
+			out << path[i - 1] << ' ';
+		}
+
+		out << destination;
+	}
+	else // no path
+	{
+		out << destination << "      " << "----";
+	}
+
+	out << std::endl;
+}
+
+// -----------------------------row()----------------------------------------
+// --Helper function returning the row of source, or nullptr if no file is
+//   open or source is out of range.
+// --------------------------------------------------------------------------
+const ExternalPaths::Entry* ExternalPaths::row(const int& source) const
+{
+	if (rows == nullptr || source <= 0 || source > size)
+	{
+		return nullptr;
+	}
+
+	return rows + static_cast<size_t>(source - 1) * (size + 1);
+}
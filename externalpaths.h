@@ -0,0 +1,78 @@
+// --------------------- externalpaths.h ----------------------------------
+//
+// Ethan Thomas
+// ------------------------------------------------------------------------
+// --Purpose: All-pairs shortest paths for graphs whose V x V result does
+//   not fit in memory. solve() runs Dijkstra's algorithm from each source
+//   of a CompressedGraph in turn and appends that source's row of
+//   distances and paths to a file as soon as it is done. Only one row is
+//   ever held in memory. open() maps a finished file so single entries can
+//   be looked up without reading the rest.
+// ------------------------------------------------------------------------
+// Assumptions:
+// --Nodes are numbered 1 to size, as in CompressedGraph.
+// --Each row holds size + 1 entries of (distance, previous node); entry 0
+//   is unused. INT_MAX and 0 mean no path, as in GraphM's T.
+// --Rows are written in source order with buffered sequential writes,
+//   which the operating system turns into large contiguous disk writes.
+//   Loading the graph memory-mapped (CompressedGraph::load()) keeps the
+//   edges out of the heap as well.
+// --The file uses the byte order of the machine that wrote it.
+// ------------------------------------------------------------------------
+
+#ifndef EXTERNALPATHS_H
+#define EXTERNALPATHS_H
+#include <iostream>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include "compressedgraph.h"
+#include "mappedfile.h"
+#include "queryworkspace.h"
+
+
+class ExternalPaths
+{
+
+public:
+	ExternalPaths();
+
+	static bool solve(const CompressedGraph& graph, const std::string& path,
+		QueryWorkspace& workspace);
+
+	bool open(const std::string& path);
+
+	int getSize() const;
+	int getDist(const int& source, const int& destination) const;
+	int getParent(const int& source, const int& destination) const;
+
+	void display(const int& source, const int& destination, std::ostream& out) const;
+
+
+
+private:
+
+	struct Entry
+	{
+		int32_t dist;               // shortest distance, INT_MAX if none
+		int32_t path;               // previous node in path, 0 if none
+	};
+
+	struct FileHeader
+	{
+		char magic[8];              // FILE_MAGIC
+		uint32_t size;              // number of nodes
+		uint32_t unused;            // keeps the rows 8-byte aligned
+	};
+
+	static const char FILE_MAGIC[8];
+
+	const Entry* row(const int& source) const;
+
+	std::shared_ptr<const MappedFile> mapping;  // the open result file
+	int size;                                   // number of nodes
+	const Entry* rows;                          // row 1 of the file
+
+
+};
+#endif // !EXTERNALPATHS_H
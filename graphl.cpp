@@ -13,68 +13,212 @@ GraphL::GraphL()
 	makeEmpty();
 }
 
+// -------------------------Copy Constructor---------------------------------
+// --Takes a copy-on-write snapshot of other, sharing its adjacency table.
+// --------------------------------------------------------------------------
+GraphL::GraphL(const GraphL& other)
+	: size(other.size), adj(other.adj)
+{
+}
+
+// -------------------------Move Constructor---------------------------------
+// --Takes over other's adjacency table in O(1). other is left as an empty
+//   graph.
+// --------------------------------------------------------------------------
+GraphL::GraphL(GraphL&& other) noexcept
+	: size(other.size), adj(std::move(other.adj))
+{
+	other.makeEmpty();
+}
+
 // ---------------------------MakeEmpty--------------------------------------
-// --Helper function that initializes adjNodeList values.
+// --Helper function that points adj at the shared empty table.
 // --Sets size to 0.
 // --------------------------------------------------------------------------
 void GraphL::makeEmpty()
 {
 	size = 0;
-
-	for (int i = 0; i < MAXNODES_L; i++)
-	{
-		adjNodeList[i].visited = false;
-		adjNodeList[i].edgeHead = nullptr;
-		adjNodeList[i].data = nullptr;
-	}
+	adj = emptyTable();
 }
 
 // ----------------------------Destructor------------------------------------
-// --Deletes all allocated memory using helper function deleteAll().
+// --Releases this graph's hold on its adjacency table using helper function
+//   deleteAll(). The table itself is deleted with its last snapshot.
 // --------------------------------------------------------------------------
 GraphL::~GraphL()
 {
 	deleteAll();
 }
 
-// ----------------------------Destructor------------------------------------
-// --Helper function that deletes all allocated memory.
+// -------------------------operator=(copy)----------------------------------
+// --Makes *this a copy-on-write snapshot of rhs.
+// --------------------------------------------------------------------------
+GraphL& GraphL::operator=(const GraphL& rhs)
+{
+	if (this != &rhs)
+	{
+		size = rhs.size;
+		adj = rhs.adj;
+	}
+
+	return *this;
+}
+
+// -------------------------operator=(move)----------------------------------
+// --Takes over rhs's adjacency table in O(1). rhs is left as an empty graph.
+// --------------------------------------------------------------------------
+GraphL& GraphL::operator=(GraphL&& rhs) noexcept
+{
+	if (this != &rhs)
+	{
+		size = rhs.size;
+		adj = std::move(rhs.adj);
+		rhs.makeEmpty();
+	}
+
+	return *this;
+}
+
+// ----------------------------deleteAll()-----------------------------------
+// --Helper function that drops this graph's adjacency table and resets it
+//   to empty.
 // --------------------------------------------------------------------------
 void GraphL::deleteAll()
 {
 	if (size > 0)
 	{
-		// traverses the entire graph array up to the size of the graph
-		for (int i = 1; i <= size; i++)
-		{
-			// the head of the list
-			EdgeNode* current = adjNodeList[i].edgeHead;
-			delete adjNodeList[i].data;
+		makeEmpty();
+	}
+}
+
+// ---------------------------emptyTable()-----------------------------------
+// --Helper function returning the adjacency table shared by every empty
+//   graph.
+// --------------------------------------------------------------------------
+const std::shared_ptr<GraphL::AdjacencyTable>& GraphL::emptyTable()
+{
+	static const std::shared_ptr<AdjacencyTable> empty = std::make_shared<AdjacencyTable>();
+	return empty;
+}
 
-			// deletes each node in the list
-			while (current != nullptr)
+// ----------------------AdjacencyTable Constructor--------------------------
+// --Initializes every node without data or edges.
+// --------------------------------------------------------------------------
+GraphL::AdjacencyTable::AdjacencyTable()
+	: offset(MAXNODES_L + 1, 0), bitsetRow(MAXNODES_L, -1)
+{
+	for (int i = 0; i < MAXNODES_L; i++) // numbered as read
+	{
+		toInternal[i] = i;
+		toExternal[i] = i;
+	}
+}
+
+// ----------------------finishEdges()---------------------------------------
+// --Turns the edges collected in inserted into the per-node ranges.
+//   Edges are grouped by source with a counting sort, laid out most
+//   recently inserted first, and only the first copy of a repeated edge is
+//   kept. Then indexEdges() builds the sorted ranges and bitset rows.
+// --------------------------------------------------------------------------
+void GraphL::AdjacencyTable::finishEdges()
+{
+	offset.assign(MAXNODES_L + 1, 0);
+
+	for (size_t i = 0; i < inserted.size(); i++) // count edges per source
+	{
+		offset[inserted[i].first + 1]++;
+	}
+
+	for (int v = 0; v < MAXNODES_L; v++)
+	{
+		offset[v + 1] += offset[v];
+	}
+
+	std::vector<int> next(offset.begin(), offset.end() - 1);
+	edges.resize(inserted.size());
+
+	for (size_t i = inserted.size(); i > 0; i--) // newest first
+	{
+		edges[next[inserted[i - 1].first]++] = inserted[i - 1].second;
+	}
+
+	std::vector<int> seenFrom(MAXNODES_L, -1); // source that last kept the node
+	int kept = 0, begin = 0;
+
+	for (int v = 0; v < MAXNODES_L; v++) // drop repeats, compacting in place
+	{
+		int end = offset[v + 1];
+		offset[v] = kept;
+
+		for (int i = begin; i < end; i++)
+		{
+			if (seenFrom[edges[i]] != v)
 			{
-				// makes sure to keep connection after deleting current node
-				EdgeNode* next = current->nextEdge;
-				delete current;
-				current = next;
+				seenFrom[edges[i]] = v;
+				edges[kept++] = edges[i];
 			}
+		}
+
+		begin = end;
+	}
+
+	offset[MAXNODES_L] = kept;
+
+	edges.resize(kept);
+	edges.shrink_to_fit();
+	std::vector<std::pair<int, int> >().swap(inserted);
+
+	indexEdges();
+}
+
+// ----------------------indexEdges()----------------------------------------
+// --Builds the sorted copy of every node's edges and the bitset rows of
+//   nodes with high degree from offset and edges.
+// --------------------------------------------------------------------------
+void GraphL::AdjacencyTable::indexEdges()
+{
+	const int wordsPerRow = (MAXNODES_L + 63) / 64;
+
+	sorted = edges;
+	bitsetRow.assign(MAXNODES_L, -1);
+	bits.clear();
+
+	for (int v = 0; v < MAXNODES_L; v++)
+	{
+		std::sort(sorted.begin() + offset[v], sorted.begin() + offset[v + 1]);
 
-			adjNodeList[i].edgeHead = nullptr;
-			adjNodeList[i].visited = false;
+		if (offset[v + 1] - offset[v] >= HASEDGE_BITSET_DEGREE)
+		{
+			bitsetRow[v] = static_cast<int>(bits.size());
+			bits.resize(bits.size() + wordsPerRow, 0);
+
+			for (int i = offset[v]; i < offset[v + 1]; i++)
+			{
+				bits[bitsetRow[v] + edges[i] / 64] |= uint64_t(1) << (edges[i] % 64);
+			}
 		}
-		size = 0;
 	}
 }
 
 // --------------------- buildGraph() -----------------------------------------
 // --Builds up graph node information and adjacency list of edges between each
-//   node reading from a data file.
+//   node reading from a data file. Invalid edges are reported to cout.
+// --------------------------------------------------------------------------
+void GraphL::buildGraph(istream & infile)
+{
+	buildGraph(infile, std::cout);
+}
+
+// --------------------- buildGraph() -----------------------------------------
+// --Builds up graph node information and adjacency list of edges between each
+//   node reading from a data file. Invalid edges are reported to errors.
 // --Assumes instance(*this) may not be empty when buildGraph() is called.
 // --Uses helper function insertEdge().
 // --------------------------------------------------------------------------
-void GraphL::buildGraph(ifstream & infile)
+void GraphL::buildGraph(istream & infile, ostream & errors)
 {
+	TRACE_SCOPE("GraphL::buildGraph");
+
 	int nodeCount = 0;
 	infile >> nodeCount; // takes in amount of nodes
 
@@ -85,6 +229,7 @@ void GraphL::buildGraph(ifstream & infile)
 			deleteAll();
 		}
 
+		adj = std::make_shared<AdjacencyTable>(); // snapshots keep the old table
 		size = nodeCount; // set size
 
 		string description = "";
@@ -92,8 +237,7 @@ void GraphL::buildGraph(ifstream & infile)
 
 		for (int i = 1; i <= size; i++) // insert edge names
 		{
-			adjNodeList[i].data = new NodeData;
-			adjNodeList[i].data->setData(infile);
+			adj->data[i].setData(infile);
 		} 
 
 		int source = 0, destination = 0;
@@ -102,17 +246,67 @@ void GraphL::buildGraph(ifstream & infile)
 		{
 			if (!insertEdge(source, destination)) // try and insert, if false print out error statement
 			{
-				std::cout << "Error: Could not insert edge (" << source << ", " << 
+				errors << "Error: Could not insert edge (" << source << ", " << 
 					destination << std::endl;
 			}
 		}
+
+		adj->finishEdges();
 	}
 }
 
+// ---------------------relabel()--------------------------------------------
+// --Renumbers the nodes internally in the given order and lays the node
+//   data and edges out again in that order. Each node keeps the order of
+//   its edges, and the original numbers are kept for every public function.
+// --The new layout goes into a new table, so snapshots sharing the old one
+//   are not affected.
+// --------------------------------------------------------------------------
+void GraphL::relabel(const VertexOrder& order)
+{
+	if (size == 0 || order == ORDER_IDENTITY)
+	{
+		return;
+	}
+
+	std::vector<int> newToOld = vertexOrder(order, size, adj->offset, adj->edges);
+	std::vector<int> oldToNew(MAXNODES_L, 0);
+	std::shared_ptr<AdjacencyTable> next = std::make_shared<AdjacencyTable>();
+
+	for (int v = 1; v <= size; v++)
+	{
+		oldToNew[newToOld[v]] = v;
+	}
+
+	next->offset[0] = 0;
+	next->edges.reserve(adj->edges.size());
+
+	for (int v = 0; v < MAXNODES_L; v++)
+	{
+		int old = (v <= size) ? newToOld[v] : v; // unused nodes keep their place
+		int original = adj->toExternal[old];
+
+		next->data[v] = adj->data[old];
+		next->toExternal[v] = original;
+		next->toInternal[original] = v;
+		next->offset[v] = static_cast<int>(next->edges.size());
+
+		for (int e = adj->offset[old]; e < adj->offset[old + 1]; e++)
+		{
+			next->edges.push_back(oldToNew[adj->edges[e]]);
+		}
+	}
+
+	next->offset[MAXNODES_L] = static_cast<int>(next->edges.size());
+	next->indexEdges();
+	adj = next;
+}
+
 // ---------------------insertEdge()-----------------------------------------
 // --Helper function for buildGraph().
-// --First verifys data is valid (validData), if true then inserts an edge 
-//   into a graph between 2 given nodes and returns true(validInput).
+// --First verifys data is valid (validData), if true then records an edge 
+//   between 2 given nodes and returns true(validInput). The edge is laid
+//   out with the rest by finishEdges() once every edge has been read.
 // --If false then does nothing and returns false(validInput).
 // --------------------------------------------------------------------------
 bool GraphL::insertEdge(const int & source, const int & destination)
@@ -121,99 +315,154 @@ bool GraphL::insertEdge(const int & source, const int & destination)
 					   destination > 0 && destination <= size && source != destination);
 	if (validInput)    // input is within list bounds
 	{
-		EdgeNode* tempPtr = new EdgeNode;
-		tempPtr->adjGraphNode = destination;
-		tempPtr->nextEdge = nullptr;
-
-		// connects the new edge node to the adjacency list, always adding to front
-		EdgeNode* next = adjNodeList[source].edgeHead;
-		adjNodeList[source].edgeHead = tempPtr;
-		tempPtr->nextEdge = next;
+		adj->inserted.push_back(std::make_pair(source, destination));
 	} // end if (success)
 
 	return validInput;
 
 }
 
+// ---------------------hasEdge()--------------------------------------------
+// --Returns true if the graph has an edge from source to destination. Uses
+//   the bitset row of source if it has one, and otherwise binary searches
+//   its sorted edges.
+// --------------------------------------------------------------------------
+bool GraphL::hasEdge(const int& source, const int& destination) const
+{
+	if (source <= 0 || source > size || destination <= 0 || destination > size)
+	{
+		return false;
+	}
+
+	int from = adj->toInternal[source], to = adj->toInternal[destination];
+	int row = adj->bitsetRow[from];
+
+	if (row >= 0) // high degree node
+	{
+		return ((adj->bits[row + to / 64] >> (to % 64)) & 1) != 0;
+	}
+
+	return std::binary_search(adj->sorted.begin() + adj->offset[from],
+		adj->sorted.begin() + adj->offset[from + 1], to);
+}
+
+// ---------------------compress()-------------------------------------------
+// --Returns the edges packed into an unweighted CompressedGraph, numbered
+//   as in the input.
+// --------------------------------------------------------------------------
+CompressedGraph GraphL::compress() const
+{
+	std::vector<CompressedGraph::Edge> edges;
+	edges.reserve(adj->edges.size());
+
+	for (int v = 1; v <= size; v++)
+	{
+		for (int e = adj->offset[v]; e < adj->offset[v + 1]; e++)
+		{
+			CompressedGraph::Edge edge;
+			edge.source = adj->toExternal[v];
+			edge.destination = adj->toExternal[adj->edges[e]];
+			edge.weight = 1;
+			edges.push_back(edge);
+		}
+	}
+
+	return CompressedGraph(size, std::move(edges), false);
+}
+
 // ---------------------displayGraph()---------------------------------------
-// --Prints each node description and all paths in the graph.
+// --Prints each node description and all paths in the graph to cout.
 // --------------------------------------------------------------------------
 void GraphL::displayGraph() const
 {
-	EdgeNode* current;      // for edge list traversal
+	displayGraph(std::cout);
+}
 
-	std::cout << std::endl << "Graph:" << std::endl;
+// ---------------------displayGraph()---------------------------------------
+// --Prints each node description and all paths in the graph to out.
+// --------------------------------------------------------------------------
+void GraphL::displayGraph(ostream& out) const
+{
+	out << std::endl << "Graph:" << std::endl;
 
 	for (int i = 1; i <= size; i++)
 	{
-		std::cout << "Node" << i << "          "
-			<< *adjNodeList[i].data << std::endl; // print description
+		int v = adj->toInternal[i];
 
-		current = adjNodeList[i].edgeHead;
+		out << "Node" << i << "          "
+			<< adj->data[v] << std::endl; // print description
 
-		while (current != nullptr) // print paths
+		for (int e = adj->offset[v]; e < adj->offset[v + 1]; e++) // print paths
 		{
-			std::cout << "  edge  " << i << "  " << current->adjGraphNode << std::endl;
-			current = current->nextEdge;
+			out << "  edge  " << i << "  " << adj->toExternal[adj->edges[e]] << std::endl;
 		}
 		
-		std::cout << std::endl;
+		out << std::endl;
 	} 
 
-	std::cout << std::endl;
+	out << std::endl;
+}
+
+// ---------------------depthFirstSearch()-----------------------------------
+// --Makes a depth-first search and prints each node in depth-first order,
+//   using the calling thread's workspace.
+// --------------------------------------------------------------------------
+void GraphL::depthFirstSearch() const
+{
+	depthFirstSearch(std::cout, QueryWorkspace::local());
 }
 
 // ---------------------depthFirstSearch()-----------------------------------
-// --Makes a depth-first search and prints each node in depth-first order.
-// --Uses helper functions resetVisited() and dfsHelper().
+// --Makes a depth-first search and prints each node in depth-first order
+//   to cout.
 // --------------------------------------------------------------------------
-void GraphL::depthFirstSearch()
+void GraphL::depthFirstSearch(QueryWorkspace& workspace) const
 {
-	resetVisted(); // resets visits
+	depthFirstSearch(std::cout, workspace);
+}
+
+// ---------------------depthFirstSearch()-----------------------------------
+// --Makes a depth-first search and prints each node in depth-first order
+//   to out. Visited flags are kept in workspace, which begin() resets in
+//   O(1).
+// --Uses helper function dfsHelper().
+// --------------------------------------------------------------------------
+void GraphL::depthFirstSearch(ostream& out, QueryWorkspace& workspace) const
+{
+	TRACE_SCOPE("GraphL::depthFirstSearch");
+
+	workspace.begin(MAXNODES_L); // resets visits
 
-	cout << endl << "Depth-first ordering: ";
+	out << endl << "Depth-first ordering: ";
 
-	for (int vertex = 1; vertex <= size; vertex++)
+	for (int i = 1; i <= size; i++) // in original order
 	{
-		if (!adjNodeList[vertex].visited) //if not visited
+		int vertex = adj->toInternal[i];
+
+		if (!workspace.isVisited(vertex)) //if not visited
 		{
-			dfsHelper(vertex); // call helper function
+			dfsHelper(vertex, workspace, out); // call helper function
 		}
 	} 
 
-	cout << endl << endl;
-}
-
-// -------------------------resetVisited()-----------------------------------
-// --Helper function that resets all adjNodeList.visited to false. 
-// --------------------------------------------------------------------------
-void GraphL::resetVisted()
-{
-	for (int i = 1; i < MAXNODES_L; i++)
-	{
-		adjNodeList[i].visited = false;
-	}
+	out << endl << endl;
 }
 
 // ---------------------------dfsHelper()------------------------------------
 // --Helper function for depthFirstSearch(). Recursively finds the
-//   depthFirstSearch
+//   depthFirstSearch from internal node vertex.
 // --------------------------------------------------------------------------
-void GraphL::dfsHelper(const int& vertex)
+void GraphL::dfsHelper(const int& vertex, QueryWorkspace& workspace, ostream& out) const
 {
-	EdgeNode* current = adjNodeList[vertex].edgeHead;
+	workspace.markVisited(vertex);
+	out << adj->toExternal[vertex] << ' ';
 
-	adjNodeList[vertex].visited = true;
-	cout << vertex << ' ';
-
-	while (current != nullptr)
+	for (int e = adj->offset[vertex]; e < adj->offset[vertex + 1]; e++)
 	{
-		if (!adjNodeList[current->adjGraphNode].visited)
+		if (!workspace.isVisited(adj->edges[e]))
 		{
-			dfsHelper(current->adjGraphNode);
+			dfsHelper(adj->edges[e], workspace, out);
 		}
-
-		current = current->nextEdge;
 	}
 }
 
@@ -16,6 +16,28 @@
 // --This is an unweighted graph.
 // --Max node input will be 100, but since index 0 is not used, constant is set
 //   to 101 (MAXNODES_L).
+// --Duplicate edges in the input are stored once. Each node's edges are
+//   kept in the order the original linked lists gave them, most recently
+//   inserted first, so displayGraph() and depthFirstSearch() print the same
+//   order as before. A second, sorted copy of every node's edges answers
+//   hasEdge() by binary search. Nodes with at least HASEDGE_BITSET_DEGREE
+//   edges also get a bitset row and answer it in O(1).
+// --relabel() renumbers the nodes internally (see vertexorder.h) so that
+//   nodes searched together sit together in the adjacency table. Every
+//   public function takes and prints the original node numbers, and the
+//   output is the same with or without relabeling.
+// --compress() packs the edges into a CompressedGraph using the original
+//   node numbers, for traversals that only need the edges.
+// --Node data and edge lists live on the heap in an adjacency table held
+//   behind a shared handle. Moving a GraphL is O(1) and copying one takes a
+//   copy-on-write snapshot that shares the table. The table is never
+//   written after buildGraph() returns; rebuilding a graph gives it a new
+//   table and leaves the old one to any snapshots still using it.
+// --depthFirstSearch() keeps its visited flags in a QueryWorkspace rather
+//   than in the graph, so any number of threads can search the same graph
+//   at once. The overload without one uses the calling thread's.
+// --buildGraph() and depthFirstSearch() are recorded as trace spans when
+//   tracing is enabled (see trace.h).
 // ------------------------------------------------------------------------
 
 
@@ -23,25 +45,49 @@
 #define GRAPHL_H
 
 #include "nodedata.h"
+#include "queryworkspace.h"
+#include "vertexorder.h"
+#include "compressedgraph.h"
+#include "trace.h"
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
 
 
-int const MAXNODES_L = 101; //constant size for adjNodeList
+int const MAXNODES_L = 101; //constant size for the adjacency table
+int const HASEDGE_BITSET_DEGREE = 16; //smallest degree given a bitset row
 
 class GraphL
 {
 public:
 	GraphL();
+	GraphL(const GraphL& other);
+	GraphL(GraphL&& other) noexcept;
 	~GraphL();
 
-	void buildGraph(ifstream& infile);
+	GraphL& operator=(const GraphL& rhs);
+	GraphL& operator=(GraphL&& rhs) noexcept;
+
+	void buildGraph(istream& infile);
+	void buildGraph(istream& infile, ostream& errors);
+	void relabel(const VertexOrder& order);
 
 	
 
 	void displayGraph()const;
-	void depthFirstSearch();
+	void displayGraph(ostream& out)const;
+	void depthFirstSearch() const;
+	void depthFirstSearch(QueryWorkspace& workspace) const;
+	void depthFirstSearch(ostream& out, QueryWorkspace& workspace) const;
+
+	bool hasEdge(const int& source, const int& destination) const;
+
+	CompressedGraph compress() const;
 
 
 
@@ -50,26 +96,32 @@ private:
 	void makeEmpty();
 	void deleteAll();
 	bool insertEdge(const int& source, const int& destination);
-	void resetVisted();
-	void dfsHelper(const int& vertex);
+	void dfsHelper(const int& vertex, QueryWorkspace& workspace, ostream& out) const;
 	
 
 	int size;
-	struct EdgeNode;
-	struct GraphNode
-	{
-		EdgeNode* edgeHead;
-		NodeData* data;
-		bool visited;
-	};
 
-	struct EdgeNode
+	struct AdjacencyTable
 	{
-		int adjGraphNode;
-		EdgeNode* nextEdge;
+		AdjacencyTable();
+
+		void finishEdges();
+		void indexEdges();
+
+		NodeData data[MAXNODES_L];                   // node descriptions, by internal number
+		int toInternal[MAXNODES_L];                  // internal number of each original node
+		int toExternal[MAXNODES_L];                  // original number of each internal node
+		std::vector<std::pair<int, int> > inserted;  // edges as read, emptied by finishEdges()
+		std::vector<int> offset;                     // edges of v are [offset[v], offset[v + 1])
+		std::vector<int> edges;                      // internal numbers, each range most recently inserted first
+		std::vector<int> sorted;                     // each range in ascending order
+		std::vector<int> bitsetRow;                  // first word of v's row in bits, or -1
+		std::vector<uint64_t> bits;                  // rows for nodes of high degree
 	};
 
-	GraphNode adjNodeList[MAXNODES_L];
+	static const std::shared_ptr<AdjacencyTable>& emptyTable();
+
+	std::shared_ptr<AdjacencyTable> adj; // only written by buildGraph(), while unshared
 
 	
 
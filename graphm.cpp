@@ -13,71 +13,225 @@ GraphM::GraphM()
 	makeEmpty();
 }
 
+// -------------------------Copy Constructor---------------------------------
+// --Takes a copy-on-write snapshot of other. No table is copied here; the
+//   node data, cost array and path table are shared until one side writes.
+// --------------------------------------------------------------------------
+GraphM::GraphM(const GraphM& other)
+	: data(other.data), C(other.C), size(other.size), T(other.T)
+{
+}
+
+// -------------------------Move Constructor---------------------------------
+// --Takes over other's tables in O(1). other is left as an empty graph.
+// --------------------------------------------------------------------------
+GraphM::GraphM(GraphM&& other) noexcept
+	: data(std::move(other.data)), C(std::move(other.C)), size(other.size),
+	  T(std::move(other.T))
+{
+	other.makeEmpty();
+}
+
+// --------------------------Destructor--------------------------------------
+// --Needed so instances are deleteted properly. The shared handles release
+//   each table once its last snapshot is gone.
+// --------------------------------------------------------------------------
+GraphM::~GraphM()
+{
+	
+}
+
+// -------------------------operator=(copy)----------------------------------
+// --Makes *this a copy-on-write snapshot of rhs.
+// --------------------------------------------------------------------------
+GraphM& GraphM::operator=(const GraphM& rhs)
+{
+	if (this != &rhs)
+	{
+		data = rhs.data;
+		C = rhs.C;
+		size = rhs.size;
+		T = rhs.T;
+	}
+
+	return *this;
+}
+
+// -------------------------operator=(move)----------------------------------
+// --Takes over rhs's tables in O(1). rhs is left as an empty graph.
+// --------------------------------------------------------------------------
+GraphM& GraphM::operator=(GraphM&& rhs) noexcept
+{
+	if (this != &rhs)
+	{
+		data = std::move(rhs.data);
+		C = std::move(rhs.C);
+		size = rhs.size;
+		T = std::move(rhs.T);
+		rhs.makeEmpty();
+	}
+
+	return *this;
+}
+
 // ---------------------------MakeEmpty--------------------------------------
-// --Helper function that initializes all C and T values.
+// --Helper function that points every table at the shared empty tables, in
+//   which all C and T values are initialized.
 // --Sets size to 0.
 // --------------------------------------------------------------------------
 void GraphM::makeEmpty()
 {
 	size = 0;
+	data = emptyData();
+	C = emptyCost();
+	T = emptyPaths();
+}
 
-	for (int i = 0; i < MAXNODES_M; i++)
+// ---------------------------emptyData()------------------------------------
+// --Helper function returning the node table shared by every empty graph.
+// --------------------------------------------------------------------------
+const std::shared_ptr<const GraphM::NodeTable>& GraphM::emptyData()
+{
+	static const std::shared_ptr<const NodeTable> empty = std::make_shared<NodeTable>();
+	return empty;
+}
+
+// ---------------------------emptyCost()------------------------------------
+// --Helper function returning the cost array shared by every empty graph,
+//   with every cell set to INT_MAX (no edge).
+// --------------------------------------------------------------------------
+const std::shared_ptr<GraphM::CostTable>& GraphM::emptyCost()
+{
+	static const std::shared_ptr<CostTable> empty = []()
 	{
-		for (int j = 0; j < MAXNODES_M; j++)
+		std::shared_ptr<CostTable> table = std::make_shared<CostTable>();
+
+		for (int i = 0; i < MAXNODES_M; i++)
 		{
-			C[i][j] = INT_MAX;
-			T[i][j].visited = false;
-			T[i][j].dist = INT_MAX;
-			T[i][j].path = 0;
+			for (int j = 0; j < MAXNODES_M; j++)
+			{
+				table->cell[i][j] = INT_MAX;
+			}
+		}
+
+		return table;
+	}();
+
+	return empty;
+}
 
+// ---------------------------emptyPaths()-----------------------------------
+// --Helper function returning the path table shared by every empty graph,
+//   with every cell at infinite distance and without a path.
+// --------------------------------------------------------------------------
+const std::shared_ptr<GraphM::PathTable>& GraphM::emptyPaths()
+{
+	static const std::shared_ptr<PathTable> empty = []()
+	{
+		std::shared_ptr<PathTable> table = std::make_shared<PathTable>();
+
+		for (int i = 0; i < MAXNODES_M; i++)
+		{
+			for (int j = 0; j < MAXNODES_M; j++)
+			{
+				table->cell[i][j].dist = INT_MAX;
+				table->cell[i][j].path = 0;
+			}
 		}
+
+		return table;
+	}();
+
+	return empty;
+}
+
+// ---------------------------detachCost()-----------------------------------
+// --Helper function called before C is written. If C is shared with another
+//   snapshot (or is the shared empty table), gives *this its own copy.
+// --A count of 1 may have been reached by a snapshot on another thread
+//   dropping its handle. The acquire fence pairs with the release in that
+//   decrement, so the other thread's reads of C happen before the write.
+// --------------------------------------------------------------------------
+void GraphM::detachCost()
+{
+	if (C.use_count() != 1)
+	{
+		C = std::make_shared<CostTable>(*C);
+	}
+	else
+	{
+		std::atomic_thread_fence(std::memory_order_acquire);
 	}
 }
 
-// --------------------------Destructor--------------------------------------
-// --Needed so instances are deleteted properly.
+// ---------------------------detachPaths()----------------------------------
+// --Helper function called before T is written. If T is shared with another
+//   snapshot (or is the shared empty table), gives *this its own copy.
+//   Fenced like detachCost().
 // --------------------------------------------------------------------------
-GraphM::~GraphM()
+void GraphM::detachPaths()
 {
-	
+	if (T.use_count() != 1)
+	{
+		T = std::make_shared<PathTable>(*T);
+	}
+	else
+	{
+		std::atomic_thread_fence(std::memory_order_acquire);
+	}
 }
 
 // ----------------------buildGraph()----------------------------------------
 // --Builds up graph node information and adjacency matrix of edges
-//   between each node reading from a file.
+//   between each node reading from a file. Invalid edges are reported to
+//   cout.
+// --------------------------------------------------------------------------
+void GraphM::buildGraph(istream& infile)
+{
+	buildGraph(infile, std::cout);
+}
+
+// ----------------------buildGraph()----------------------------------------
+// --Builds up graph node information and adjacency matrix of edges
+//   between each node reading from a file. Invalid edges are reported to
+//   errors.
 // --If nodeCount <= 0 or nodeCount > MAXNODES_M then buildgraph does nothing.
 // --Assumes instance(*this) may not be empty when buildGraph() is called.
-// --Uses insertEdge to verify data and insert if data is valid.
+// --Uses setEdge to verify data and insert if data is valid. Shortest paths
+//   are not computed; call findShortestPath() once the graph is built.
 // --------------------------------------------------------------------------
-void GraphM::buildGraph(ifstream& infile)
+void GraphM::buildGraph(istream& infile, ostream& errors)
 {
+	TRACE_SCOPE("GraphM::buildGraph");
+
 	int nodeCount = 0;
 	infile >> nodeCount; //reads in node size
 
 	if (nodeCount > 0 && nodeCount < MAXNODES_M) //verifys size is within range
 	{
-		if (this->size != 0) //in case *this already has data
-		{
-			makeEmpty();
-		}
+		makeEmpty(); //in case *this already has data
 
 		size = nodeCount; // sets size
 
 		string description = "";
 		getline(infile, description);		// grab a line off file
 
+		std::shared_ptr<NodeTable> nodes = std::make_shared<NodeTable>();
+
 		for (int i = 1; i <= this->size; i++)
 		{
-			this->data[i].setData(infile);	// set each node name
+			nodes->cell[i].setData(infile);	// set each node name
 		}
 
+		data = nodes; // node data is read-only from here on
+
 		int source = 0, destination = 0, distance = 0;
 
 		while ((infile >> source >> destination >> distance) && source != 0)	//read file and levarge as a bool and checks eof
 		{
-			if (!insertEdge(source, destination, distance)) // inserts or prints out error statement
+			if (!setEdge(source, destination, distance)) // inserts or prints out error statement
 			{
-				std::cout << "Error: Could not insert edge (" << source << ", " <<
+				errors << "Error: Could not insert edge (" << source << ", " <<
 					destination << ") with cost of " << distance << std::endl;
 			}
 		}
@@ -93,14 +247,33 @@ void GraphM::buildGraph(ifstream& infile)
 // --If false then does nothing and returns false(validInput).
 // --------------------------------------------------------------------------
 bool GraphM::insertEdge(const int& source, const int& destination, const int& distance)
+{
+	bool validInput = setEdge(source, destination, distance);
+
+	if (validInput)    // input is within matrix bounds
+	{
+		findShortestPath();						  // used to mitigate user error
+	}
+
+	return validInput;
+}
+
+// ---------------------setEdge()--------------------------------------------
+// --Verifys data is valid, and if so writes the cost into C without
+//   recomputing shortest paths. A distance of INT_MAX removes the edge.
+//   Returns whether the input was valid.
+// --Used by buildGraph() and insertEdge(), and by callers applying several
+//   changes before one findShortestPath().
+// --------------------------------------------------------------------------
+bool GraphM::setEdge(const int& source, const int& destination, const int& distance)
 {
 	bool validInput = (source > 0 && source <= size && distance >= 0 &&
 		destination > 0 && destination <= size && source != destination); //checks if data is valid
 
 	if (validInput)    // input is within matrix bounds
 	{
-		C[source][destination] = distance;         // update cell with cost
-		findShortestPath();						  // used to mitigate user error
+		detachCost();
+		C->cell[source][destination] = distance;   // update cell with cost
 	}
 
 	return validInput;
@@ -118,7 +291,8 @@ bool GraphM::removeEdge(const int& source, const int& destination)
 
 	if (validInput)    // input is within matrix bounds
 	{
-		C[source][destination] = INT_MAX;         // update cell with cost
+		detachCost();
+		C->cell[source][destination] = INT_MAX;   // update cell with cost
 		findShortestPath();
 	}
 
@@ -127,147 +301,272 @@ bool GraphM::removeEdge(const int& source, const int& destination)
 
 // ----------------------findShortestPath()----------------------------------
 // --Finds the shortest path between every node to every other node
-//   in the graph using Dijkstra's algorithm.
-// --Uses helper functions resetVisited(), findMinVertex, and setWeight().
+//   in the graph using Dijkstra's algorithm, with the calling thread's
+//   workspace.
 // --------------------------------------------------------------------------
 void GraphM::findShortestPath()
 {
-	
-
-	int numVisits = 0, v = 0;
+	findShortestPath(QueryWorkspace::local());
+}
 
-	this->resetVisited(); // resets visits to false
+// ----------------------findShortestPath()----------------------------------
+// --Finds the shortest path between every node to every other node
+//   in the graph using Dijkstra's algorithm, running each source in
+//   workspace. Nothing is allocated or cleared per source once workspace
+//   has been sized.
+// --Uses helper function solveSource().
+// --------------------------------------------------------------------------
+void GraphM::findShortestPath(QueryWorkspace& workspace)
+{
+	this->detachPaths();  // snapshots sharing T keep the old results
 
-	for (int source = 1; source <= size; ++source)
+	for (int source = 1; source <= size; ++source) // internal numbers
 	{
-		numVisits = 0;
-		T[source][source].dist = 0;
-
-		while (numVisits < size)
-		{
-			v = findMinVertex(source); //find smallest value
-			T[source][v].visited = true;
-			++numVisits;
-			setWeight(source, v); //set current shorest path
-		}
+		solveSource(source, workspace);
 	} 
 	
 }
 
-// ----------------------resetVisited()-------------------------------------
-// --Helper function that resets T distance values to infinity, path to 0, and
-//   visited to false for every.
+// ----------------------findShortestPath()----------------------------------
+// --Finds the shortest path from source to every other node and updates
+//   that row of the results only, for callers that know which rows an edge
+//   change has made stale. Does nothing if source is out of range.
 // --------------------------------------------------------------------------
-void GraphM::resetVisited()
+void GraphM::findShortestPath(const int& source, QueryWorkspace& workspace)
 {
-	for (int i = 1; i <= this->size; i++)
+	if (source > 0 && source <= size)
 	{
-		for (int j = 1; j <= this->size; j++)
-		{
-			T[i][j].dist = INT_MAX;
-			T[i][j].path = 0;
-			T[i][j].visited = false;
-		}
+		this->detachPaths();
+		solveSource(source, workspace);
 	}
 }
 
-// ----------------------findMinVertex()-------------------------------------
-// --Helper function that finds a vertex for the shortest path.
+// ------------------------solveSource()-------------------------------------
+// --Helper function that runs Dijkstra's algorithm from node source in
+//   workspace and records the result in row source of T.
+// --Uses helper functions findMinVertex(), setWeight() and recordPaths().
 // --------------------------------------------------------------------------
-int GraphM::findMinVertex(const int& source) const
+void GraphM::solveSource(const int& source, QueryWorkspace& workspace)
 {
+	TRACE_SCOPE_ARG("GraphM::findShortestPath", "source", source);
+
 	int v = 0;
 
-	for (int i = 1; i <= size; ++i)
+	workspace.begin(MAXNODES_M); // O(1) reset of the previous source
+	workspace.setDist(source, 0, 0);
+	workspace.pushHeap(0, source);
+
+	while ((v = findMinVertex(workspace)) != 0)
 	{
-		if (!T[source][i].visited) // checks if it has been visited
+		workspace.markVisited(v);
+		setWeight(v, workspace); //set current shorest path
+	}
+
+	recordPaths(source, workspace);
+}
+
+// ----------------------compress()------------------------------------------
+// --Returns the edges and costs of C packed into a weighted CompressedGraph,
+//   numbered as in the input.
+// --------------------------------------------------------------------------
+CompressedGraph GraphM::compress() const
+{
+	std::vector<CompressedGraph::Edge> edges;
+
+	for (int v = 1; v <= size; v++)
+	{
+		for (int w = 1; w <= size; w++)
 		{
-			if (T[source][i].dist < T[source][v].dist) // if not compares distance
+			if (C->cell[v][w] < INT_MAX) // edge exists
 			{
-				v = i;
+				CompressedGraph::Edge edge;
+				edge.source = v;
+				edge.destination = w;
+				edge.weight = C->cell[v][w];
+				edges.push_back(edge);
 			}
 		}
 	}
 
-	return v; // returns shorter distance vertex
+	return CompressedGraph(size, std::move(edges), true);
+}
+
+// ---------------------------getSize()--------------------------------------
+// --Returns the number of nodes in the graph.
+// --------------------------------------------------------------------------
+int GraphM::getSize() const
+{
+	return size;
+}
+
+// ---------------------------getDist()--------------------------------------
+// --Returns the shortest distance from source to destination found by the
+//   last findShortestPath(), or INT_MAX if there is no path or either node
+//   is out of range.
+// --------------------------------------------------------------------------
+int GraphM::getDist(const int& source, const int& destination) const
+{
+	if (source <= 0 || source > size || destination <= 0 || destination > size)
+	{
+		return INT_MAX;
+	}
+
+	return T->cell[source][destination].dist;
+}
+
+// ---------------------------getPath()--------------------------------------
+// --Sets path to the nodes on the shortest path from source to destination,
+//   both included, as display() prints them. Returns false, leaving path
+//   empty, if there is no path.
+// --------------------------------------------------------------------------
+bool GraphM::getPath(const int& source, const int& destination, std::vector<int>& path) const
+{
+	path.clear();
+
+	if (getDist(source, destination) == INT_MAX)
+	{
+		return false;
+	}
+
+	for (int v = destination; v != 0; v = T->cell[source][v].path)
+	{
+		path.push_back(v); // ends at source, whose path is 0
+	}
+
+	std::reverse(path.begin(), path.end());
+	return true;
+}
+
+// ----------------------findMinVertex()-------------------------------------
+// --Helper function that finds the unvisited vertex with the shortest known
+//   distance, the lowest numbered one among ties. Returns 0 when every
+//   reachable vertex has been visited.
+// --Heap entries left behind by a later improvement belong to vertices that
+//   are already visited by the time they surface, so they are skipped.
+// --------------------------------------------------------------------------
+int GraphM::findMinVertex(QueryWorkspace& workspace) const
+{
+	while (!workspace.heapEmpty())
+	{
+		int v = workspace.popHeap().second;
+
+		if (!workspace.isVisited(v)) // checks if it has been visited
+		{
+			return v;
+		}
+	}
+
+	return 0; // nothing left to visit
 }
 
 // ----------------------setWeight()-----------------------------------------
 // --Helper function that sets the current shortest path information on all
-//   nodes adjacent to the visited node.
+//   nodes adjacent to the visited node v. A path whose length would reach
+//   INT_MAX is treated as no path.
 // --------------------------------------------------------------------------
-void GraphM::setWeight(const int& source, const int& v)
+void GraphM::setWeight(const int& v, QueryWorkspace& workspace) const
 {
+	const int* row = C->cell[v];
+	int distV = workspace.getDist(v);
+
 	for (int w = 1; w <= size; ++w)
 	{
-		if (!T[source][w].visited && C[v][w] < INT_MAX &&
-			T[source][v].dist < INT_MAX) //hasen't been visited and values are less than infinite
+		if (row[w] < INT_MAX && !workspace.isVisited(w)) //hasen't been visited and edge exists
 		{
-			if (T[source][w].dist > (T[source][v].dist + C[v][w])) //finds smaller value
+			long long distW = static_cast<long long>(distV) + row[w]; // cannot overflow
+
+			if (distW < INT_MAX && workspace.getDist(w) > distW) //finds smaller value
 			{
-				T[source][w].dist = T[source][v].dist + C[v][w];
-				T[source][w].path = v;
+				workspace.setDist(w, static_cast<int>(distW), v);
+				workspace.pushHeap(static_cast<int>(distW), w);
 			}
 		}
 	}
 }
 
+// ----------------------recordPaths()---------------------------------------
+// --Helper function that copies the distances and paths found from source
+//   out of workspace into row source of T.
+// --------------------------------------------------------------------------
+void GraphM::recordPaths(const int& source, const QueryWorkspace& workspace)
+{
+	for (int w = 1; w <= size; ++w)
+	{
+		T->cell[source][w].dist = workspace.getDist(w);
+		T->cell[source][w].path = workspace.getParent(w);
+	}
+}
+
 // ------------------------display()-----------------------------------------
-// --Displays the full path and distance bewtween 2 specified nodes.
-// --Uses helper functions displaypath() and displayPathNodes().
+// --Displays the full path and distance bewtween 2 specified nodes to cout.
 // --------------------------------------------------------------------------
 void GraphM::display(const int& source, const int& destination) const
 {
-	
+	display(source, destination, std::cout);
+}
 
-	if (T[source][destination].dist < INT_MAX) // prints path
+// ------------------------display()-----------------------------------------
+// --Displays the full path and distance bewtween 2 specified nodes to out.
+// --Uses helper functions displaypath() and displayPathNodes().
+// --------------------------------------------------------------------------
+void GraphM::display(const int& source, const int& destination, ostream& out) const
+{
+	if (T->cell[source][destination].dist < INT_MAX) // prints path
 	{
-		std::cout.width(4);
-		std::cout << right << source;
-		std::cout.width(8);
-		std::cout << destination;
-		std::cout.width(8);
-		std::cout << T[source][destination].dist;
-		std::cout << "        ";
-		displayPath(source, destination);
-		std::cout << destination << endl; 
-		displayPathDescrip(source, destination);
+		out.width(4);
+		out << right << source;
+		out.width(8);
+		out << destination;
+		out.width(8);
+		out << T->cell[source][destination].dist;
+		out << "        ";
+		displayPath(source, destination, out);
+		out << destination << std::endl; 
+		displayPathDescrip(source, destination, out);
 	}
 	else // no path
 	{
-		std::cout.width(4);
-		std::cout << right << source;
-		std::cout.width(8);
-		std::cout << destination << "      " << "----";
+		out.width(4);
+		out << right << source;
+		out.width(8);
+		out << destination << "      " << "----";
 	}
 	
-	std::cout << std::endl;
+	out << std::endl;
 }
 
 // ------------------------displayPath()-------------------------------------
 // --Helper function that displays full path and distance between 2 nodes.
 // --------------------------------------------------------------------------
-void GraphM::displayPath(const int& source, const int& destination) const
+void GraphM::displayPath(const int& source, const int& destination, ostream& out) const
 {
-	if (T[source][destination].path != 0)
+	if (T->cell[source][destination].path != 0)
 	{
-		displayPath(source, T[source][destination].path);
-		std::cout << T[source][destination].path << ' ';
+		displayPath(source, T->cell[source][destination].path, out);
+		out << T->cell[source][destination].path << ' ';
 	}
 }
 
 // ------------------------displayPathNodes()--------------------------------
 // --Helper function that displays description of path.
 // --------------------------------------------------------------------------
-void GraphM::displayPathDescrip(const int& source, const int& destination) const
+void GraphM::displayPathDescrip(const int& source, const int& destination, ostream& out) const
 {
-	if (source != destination && T[source][destination].path > 0)
+	if (source != destination && T->cell[source][destination].path > 0)
 	{
-		displayPathDescrip(source, T[source][destination].path);
+		displayPathDescrip(source, T->cell[source][destination].path, out);
 	}
 
 	// prints the descriptions
-	std::cout << data[destination] << std::endl;
+	out << data->cell[destination] << std::endl;
+}
+
+// ------------------------displayAll()-------------------------------------
+// --Prints the full table of shortest paths to cout.
+// --------------------------------------------------------------------------
+void GraphM::displayAll() const
+{
+	displayAll(std::cout);
 }
 
 // ------------------------displayAll()-------------------------------------
@@ -275,58 +574,60 @@ void GraphM::displayPathDescrip(const int& source, const int& destination) const
 //   and distance from every node to every other node.
 // --Uses helper function displaySource().
 // --------------------------------------------------------------------------
-void GraphM::displayAll() const
+void GraphM::displayAll(ostream& out) const
 {
+	TRACE_SCOPE("GraphM::displayAll");
+
 	//setting up print output
-	std::cout.width(26);
-	std::cout << left << "Description";
-	std::cout.width(11);
-	std::cout << "From node";
-	std::cout.width(9);
-	std::cout << "To node";
-	std::cout.width(12);
-	std::cout << "Dijkstra's";
-	std::cout.width();
-	std::cout << "Path" << std::endl;
+	out.width(26);
+	out << left << "Description";
+	out.width(11);
+	out << "From node";
+	out.width(9);
+	out << "To node";
+	out.width(12);
+	out << "Dijkstra's";
+	out.width();
+	out << "Path" << std::endl;
 
 	for (int source = 1; source <= size; ++source)
 	{
-		displaySource(source); //helper function call for each node
+		displaySource(source, out); //helper function call for each node
 	} 
 
-	std::cout << std::endl;
+	out << std::endl;
 }
 
 // ------------------------displaySource()------------------------------------
 // --Helper function that prints all the nodes that have paths from a 
 //   specified node.
 // --------------------------------------------------------------------------
-void GraphM::displaySource(const int& source) const
+void GraphM::displaySource(const int& source, ostream& out) const
 {
-	std::cout.width(32);
-	std::cout << left << data[source] << std::endl;
+	out.width(32);
+	out << left << data->cell[source] << std::endl;
 
 	for (int dest = 1; dest <= size; ++dest)
 	{
 		if (dest != source) // if it doesn't equal itself
 		{
-			std::cout.width(35);
-			std::cout << right << source;
-			std::cout.width(5);
-			std::cout << dest;
-			cout.width(14);
+			out.width(35);
+			out << right << source;
+			out.width(5);
+			out << dest;
+			out.width(14);
 
-			if (T[source][dest].dist == INT_MAX) // no path exsists
+			if (T->cell[source][dest].dist == INT_MAX) // no path exsists
 			{
-				std::cout << "----" << std::endl;
+				out << "----" << std::endl;
 			}
 			else //path exsists
 			{
-				std::cout << T[source][dest].dist;
-				std::cout.width();
-				std::cout << "    ";
-				displayPath(source, dest);
-				std::cout << dest << std::endl;
+				out << T->cell[source][dest].dist;
+				out.width();
+				out << "    ";
+				displayPath(source, dest, out);
+				out << dest << std::endl;
 			}
 		}
 	}
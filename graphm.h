@@ -16,7 +16,32 @@
 //   to 101 (MAXNODES_M).
 // --Also assumes user might misuse class by calling displayAll() without 
 //   calling findShortestPath(). To mitigate error, adding or removing an edge
-//   will also call findShortestPath().
+//   will also call findShortestPath(). buildGraph() does not, so that
+//   reading a graph costs no more than reading its file; findShortestPath()
+//   must be called once the graph is built.
+// --Node data, the cost array and the path table live on the heap behind
+//   shared handles, so moving a GraphM is O(1) and copying one takes a
+//   copy-on-write snapshot. A copy shares all three tables with the
+//   original until either side writes, at which point only the table being
+//   written is duplicated. Node data is never written after buildGraph(), so
+//   it stays shared between every snapshot of the same graph.
+// --setEdge() changes a cost without recomputing shortest paths, so that a
+//   batch of changes can be followed by a single findShortestPath(), or by
+//   findShortestPath(source, workspace) for just the sources still needed.
+//   getDist() and getPath() read the results of the last
+//   findShortestPath(), like display().
+// --compress() packs the edges and costs into a weighted CompressedGraph.
+//   Its shortestPath() finds the same distances and paths as
+//   findShortestPath() while touching only the edges that exist instead of
+//   a full row of C per node.
+// --findShortestPath() keeps its per-source scratch state in a
+//   QueryWorkspace. The overload without one uses the calling thread's.
+// --Separate GraphM objects (including snapshots of each other) may be used
+//   from different threads. A single GraphM object may be read by several
+//   threads at once, but must not be written while it is being read; see
+//   GraphMVersions for updating a graph under concurrent readers.
+// --buildGraph(), each source of findShortestPath() and displayAll() are
+//   recorded as trace spans when tracing is enabled (see trace.h).
 // ------------------------------------------------------------------------
 
 #ifndef GRAPHM_H
@@ -26,7 +51,14 @@
 #include <string>
 #include <climits>
 #include <iomanip>
+#include <memory>
+#include <atomic>
+#include <vector>
+#include <algorithm>
 #include "nodedata.h"
+#include "queryworkspace.h"
+#include "compressedgraph.h"
+#include "trace.h"
 
 
 const int MAXNODES_M = 101; //constant size for T and C
@@ -36,43 +68,81 @@ class GraphM
 
 public:
 	GraphM();
+	GraphM(const GraphM& other);
+	GraphM(GraphM&& other) noexcept;
 	~GraphM();
 
-	void buildGraph(ifstream& infile);
+	GraphM& operator=(const GraphM& rhs);
+	GraphM& operator=(GraphM&& rhs) noexcept;
+
+	void buildGraph(istream& infile);
+	void buildGraph(istream& infile, ostream& errors);
 
 	bool insertEdge(const int& source, const int& destination, const int& distance);
 	bool removeEdge(const int& source, const int& destination);
+	bool setEdge(const int& source, const int& destination, const int& distance);
 
 	void findShortestPath();
+	void findShortestPath(QueryWorkspace& workspace);
+	void findShortestPath(const int& source, QueryWorkspace& workspace);
+
+	CompressedGraph compress() const;
+
+	int getSize() const;
+	int getDist(const int& source, const int& destination) const;
+	bool getPath(const int& source, const int& destination, std::vector<int>& path) const;
 
 	void display(const int& source, const int& destination) const;
+	void display(const int& source, const int& destination, ostream& out) const;
 	void displayAll() const;
+	void displayAll(ostream& out) const;
 
 
 
 private:
 
 	void makeEmpty();
-	void resetVisited();	
+	void detachCost();
+	void detachPaths();
 
-	int findMinVertex(const int& source) const;
-	void setWeight(const int& source, const int& v);
+	void solveSource(const int& source, QueryWorkspace& workspace);
+	int findMinVertex(QueryWorkspace& workspace) const;
+	void setWeight(const int& v, QueryWorkspace& workspace) const;
+	void recordPaths(const int& source, const QueryWorkspace& workspace);
 
-	void displayPath(const int& source, const int& destination) const;
-	void displayPathDescrip(const int& source, const int& destination)const;
-	void displaySource(const int& source) const;	
+	void displayPath(const int& source, const int& destination, ostream& out) const;
+	void displayPathDescrip(const int& source, const int& destination, ostream& out)const;
+	void displaySource(const int& source, ostream& out) const;	
 
 	struct TableType
 	{
-		bool visited;          // whether node has been visited         
 		int dist;              // shortest distance from source known so far         
 		int path;              // previous node in path of min dist      
 	};
 
-	NodeData data[MAXNODES_M];              // data for graph nodes       
-	int C[MAXNODES_M][MAXNODES_M];         // Cost array, the adjacency matrix     
-	int size;                             // number of nodes in the graph     
-	TableType T[MAXNODES_M][MAXNODES_M]; // stores visited, distance, path
+	struct NodeTable
+	{
+		NodeData cell[MAXNODES_M];              // data for graph nodes
+	};
+
+	struct CostTable
+	{
+		int cell[MAXNODES_M][MAXNODES_M];       // Cost array, the adjacency matrix
+	};
+
+	struct PathTable
+	{
+		TableType cell[MAXNODES_M][MAXNODES_M]; // stores distance, path
+	};
+
+	static const std::shared_ptr<const NodeTable>& emptyData();
+	static const std::shared_ptr<CostTable>& emptyCost();
+	static const std::shared_ptr<PathTable>& emptyPaths();
+
+	std::shared_ptr<const NodeTable> data;  // data for graph nodes, never written once built
+	std::shared_ptr<CostTable> C;           // Cost array, copied before a shared write
+	int size;                               // number of nodes in the graph
+	std::shared_ptr<PathTable> T;           // stores distance, path, copied before a shared write
 
 	
 };
@@ -0,0 +1,236 @@
+// ------------------- graphmversions.cpp ---------------------------------
+//
+// Ethan Thomas
+//
+// --------------------------------------------------------------------------
+#include "graphmversions.h"
+#include <thread>
+
+// -----------------------Default Constructor--------------------------------
+// --Publishes an empty graph as the first version and marks every reader
+//   slot idle.
+// --------------------------------------------------------------------------
+GraphMVersions::GraphMVersions()
+	: current(new GraphM), globalEpoch(1)
+{
+	for (int i = 0; i < MAXREADERS_V; i++)
+	{
+		readers[i].epoch.store(0);
+	}
+}
+
+// --------------------------Destructor--------------------------------------
+// --Deletes the current version and every retired version. Assumes no
+//   ReadGuard is still alive.
+// --------------------------------------------------------------------------
+GraphMVersions::~GraphMVersions()
+{
+	for (size_t i = 0; i < retired.size(); i++)
+	{
+		delete retired[i].version;
+	}
+
+	delete current.load();
+}
+
+// ----------------------------read()----------------------------------------
+// --Pins the current version and returns a guard holding it. Never waits on
+//   the writer: claims an idle reader slot, records the epoch in it, and
+//   then loads the current version.
+// --------------------------------------------------------------------------
+GraphMVersions::ReadGuard GraphMVersions::read()
+{
+	for (;;)
+	{
+		for (int slot = 0; slot < MAXREADERS_V; slot++)
+		{
+			uint64_t idle = 0;
+			uint64_t epoch = globalEpoch.load();
+
+			// epoch is loaded before current, so a version retired after
+			// this point always carries a newer epoch than the slot
+			if (readers[slot].epoch.compare_exchange_strong(idle, epoch))
+			{
+				return ReadGuard(this, slot, current.load());
+			}
+		}
+
+		std::this_thread::yield(); // every slot busy
+	}
+}
+
+// ----------------------------publish()-------------------------------------
+// --Finds the shortest paths of graph and publishes it as the next
+//   version. Used after building a new graph, since buildGraph() does not
+//   solve. Solving happens before the writer lock is taken.
+// --------------------------------------------------------------------------
+void GraphMVersions::publish(GraphM graph)
+{
+	graph.findShortestPath();
+
+	std::lock_guard<std::mutex> lock(writerLock);
+	install(new GraphM(std::move(graph)));
+}
+
+// ---------------------insertEdge()-----------------------------------------
+// --Builds the next version from a snapshot of the current one with the
+//   edge inserted, and publishes it if the edge was valid.
+// --Readers keep seeing the current version while the shortest paths are
+//   recomputed.
+// --------------------------------------------------------------------------
+bool GraphMVersions::insertEdge(const int& source, const int& destination, const int& distance)
+{
+	std::lock_guard<std::mutex> lock(writerLock);
+
+	GraphM* next = new GraphM(*current.load());
+	bool validInput = next->insertEdge(source, destination, distance);
+
+	if (validInput)
+	{
+		install(next);
+	}
+	else
+	{
+		delete next;
+	}
+
+	return validInput;
+}
+
+// ---------------------removeEdge()-----------------------------------------
+// --Builds the next version from a snapshot of the current one with the
+//   edge removed, and publishes it if the edge was valid.
+// --------------------------------------------------------------------------
+bool GraphMVersions::removeEdge(const int& source, const int& destination)
+{
+	std::lock_guard<std::mutex> lock(writerLock);
+
+	GraphM* next = new GraphM(*current.load());
+	bool validInput = next->removeEdge(source, destination);
+
+	if (validInput)
+	{
+		install(next);
+	}
+	else
+	{
+		delete next;
+	}
+
+	return validInput;
+}
+
+// ---------------------getVersion()-----------------------------------------
+// --Returns how many versions have been published since construction.
+// --------------------------------------------------------------------------
+uint64_t GraphMVersions::getVersion() const
+{
+	return globalEpoch.load() - 1;
+}
+
+// ---------------------install()--------------------------------------------
+// --Helper function that swaps next in as the current version, retires the
+//   old one in a new epoch and deletes whatever is no longer pinned.
+// --Caller must hold writerLock.
+// --------------------------------------------------------------------------
+void GraphMVersions::install(GraphM* next)
+{
+	const GraphM* old = current.exchange(next);
+	uint64_t epoch = globalEpoch.fetch_add(1) + 1;
+
+	Retired entry;
+	entry.epoch = epoch;
+	entry.version = old;
+	retired.push_back(entry);
+
+	reclaim();
+}
+
+// ---------------------reclaim()--------------------------------------------
+// --Helper function that deletes every retired version older than the
+//   oldest epoch still pinned by a reader.
+// --Caller must hold writerLock.
+// --------------------------------------------------------------------------
+void GraphMVersions::reclaim()
+{
+	uint64_t oldestPinned = UINT64_MAX;
+
+	for (int slot = 0; slot < MAXREADERS_V; slot++)
+	{
+		uint64_t epoch = readers[slot].epoch.load();
+
+		if (epoch != 0 && epoch < oldestPinned) // busy slot
+		{
+			oldestPinned = epoch;
+		}
+	}
+
+	size_t kept = 0;
+
+	for (size_t i = 0; i < retired.size(); i++)
+	{
+		if (retired[i].epoch > oldestPinned) // a reader pinned before it was retired
+		{
+			retired[kept++] = retired[i];
+		}
+		else
+		{
+			delete retired[i].version;
+		}
+	}
+
+	retired.resize(kept);
+}
+
+// ---------------------release()--------------------------------------------
+// --Helper function that marks a reader slot idle again.
+// --------------------------------------------------------------------------
+void GraphMVersions::release(const int& slot)
+{
+	readers[slot].epoch.store(0, std::memory_order_release);
+}
+
+// -----------------------ReadGuard Constructor------------------------------
+// --Holds version pinned in the given reader slot of owner.
+// --------------------------------------------------------------------------
+GraphMVersions::ReadGuard::ReadGuard(GraphMVersions* owner, const int& slot,
+	const GraphM* version)
+	: owner(owner), slot(slot), version(version)
+{
+}
+
+// -----------------------ReadGuard Move Constructor-------------------------
+// --Takes over other's pin. other no longer releases the slot.
+// --------------------------------------------------------------------------
+GraphMVersions::ReadGuard::ReadGuard(ReadGuard&& other) noexcept
+	: owner(other.owner), slot(other.slot), version(other.version)
+{
+	other.owner = nullptr;
+}
+
+// -----------------------ReadGuard Destructor-------------------------------
+// --Unpins the version so the writer may reclaim it.
+// --------------------------------------------------------------------------
+GraphMVersions::ReadGuard::~ReadGuard()
+{
+	if (owner != nullptr)
+	{
+		owner->release(slot);
+	}
+}
+
+// -----------------------ReadGuard graph()----------------------------------
+// --Returns the pinned version.
+// --------------------------------------------------------------------------
+const GraphM& GraphMVersions::ReadGuard::graph() const
+{
+	return *version;
+}
+
+// -----------------------ReadGuard operator->-------------------------------
+// --Gives direct access to the pinned version's const members.
+// --------------------------------------------------------------------------
+const GraphM* GraphMVersions::ReadGuard::operator->() const
+{
+	return version;
+}
@@ -0,0 +1,106 @@
+// ------------------- graphmversions.h -----------------------------------
+//
+// Ethan Thomas
+// ------------------------------------------------------------------------
+// --Purpose: Let many threads query a GraphM while one thread changes its
+//   edges. Readers pin the currently published version of the graph and
+//   read its cost and result tables without taking a lock. The writer
+//   builds the next version off to the side and publishes it with a single
+//   atomic pointer swap.
+// ------------------------------------------------------------------------
+// Assumptions:
+// --A published GraphM is never written again. The writer starts each new
+//   version from a copy-on-write snapshot of the current one, so only the
+//   tables an update touches are duplicated.
+// --Old versions are reclaimed by epoch: each reader records the global
+//   epoch in a reader slot while it holds a version, and a retired version
+//   is deleted once every busy slot shows an epoch newer than the one it
+//   was retired in.
+// --At most MAXREADERS_V readers may hold a version at the same time. A
+//   reader that finds every slot busy yields until one frees up.
+// --Writers are serialized among themselves; only readers run concurrently.
+// --publish() finds the shortest paths of the graph it is given, so a graph
+//   straight from buildGraph() can be published as is.
+// --The GraphMVersions object must outlive every ReadGuard taken from it.
+// ------------------------------------------------------------------------
+
+#ifndef GRAPHMVERSIONS_H
+#define GRAPHMVERSIONS_H
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include "graphm.h"
+
+
+const int MAXREADERS_V = 64; //number of reader slots
+
+class GraphMVersions
+{
+
+public:
+	// -------------------------- ReadGuard ---------------------------------
+	// --Keeps one published version alive while it is in scope.
+	// ----------------------------------------------------------------------
+	class ReadGuard
+	{
+	public:
+		ReadGuard(ReadGuard&& other) noexcept;
+		~ReadGuard();
+
+		ReadGuard(const ReadGuard&) = delete;
+		ReadGuard& operator=(const ReadGuard&) = delete;
+		ReadGuard& operator=(ReadGuard&&) = delete;
+
+		const GraphM& graph() const;
+		const GraphM* operator->() const;
+
+	private:
+		friend class GraphMVersions;
+		ReadGuard(GraphMVersions* owner, const int& slot, const GraphM* version);
+
+		GraphMVersions* owner;   // versions the slot belongs to, nullptr once moved from
+		int slot;                // reader slot holding the pin
+		const GraphM* version;   // pinned version
+	};
+
+	GraphMVersions();
+	~GraphMVersions();
+
+	GraphMVersions(const GraphMVersions&) = delete;
+	GraphMVersions& operator=(const GraphMVersions&) = delete;
+
+	ReadGuard read();
+
+	void publish(GraphM graph);
+	bool insertEdge(const int& source, const int& destination, const int& distance);
+	bool removeEdge(const int& source, const int& destination);
+
+	uint64_t getVersion() const;
+
+private:
+
+	void install(GraphM* next);
+	void reclaim();
+	void release(const int& slot);
+
+	struct alignas(64) ReaderSlot
+	{
+		std::atomic<uint64_t> epoch;    // epoch pinned by the reader, 0 when idle
+	};
+
+	struct Retired
+	{
+		uint64_t epoch;                 // epoch the version was retired in
+		const GraphM* version;          // version waiting to be deleted
+	};
+
+	std::atomic<const GraphM*> current;    // most recently published version
+	std::atomic<uint64_t> globalEpoch;     // bumped on every publish
+	ReaderSlot readers[MAXREADERS_V];      // one per active reader
+	std::mutex writerLock;                 // serializes writers
+	std::vector<Retired> retired;          // guarded by writerLock
+
+
+};
+#endif // !GRAPHMVERSIONS_H
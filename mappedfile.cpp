@@ -0,0 +1,106 @@
+// ---------------------- mappedfile.cpp ----------------------------------
+//
+// Ethan Thomas
+//
+// --------------------------------------------------------------------------
+#include "mappedfile.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// -----------------------Default Constructor--------------------------------
+// --Constructs a closed mapping.
+// --------------------------------------------------------------------------
+MappedFile::MappedFile()
+	: address(nullptr), size(0)
+{
+}
+
+// --------------------------Destructor--------------------------------------
+// --Unmaps the file.
+// --------------------------------------------------------------------------
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+// ----------------------------open()----------------------------------------
+// --Maps the file at path read-only. Returns false if it cannot be opened
+//   or mapped, or is empty.
+// --------------------------------------------------------------------------
+bool MappedFile::open(const std::string& path)
+{
+	close();
+
+	int fd = ::open(path.c_str(), O_RDONLY);
+	struct stat info;
+
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	if (fstat(fd, &info) != 0 || info.st_size <= 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd); // the mapping keeps the file open
+
+	if (mapped == MAP_FAILED)
+	{
+		return false;
+	}
+
+	address = mapped;
+	size = static_cast<size_t>(info.st_size);
+	return true;
+}
+
+// ----------------------------close()---------------------------------------
+// --Unmaps the file if one is mapped.
+// --------------------------------------------------------------------------
+void MappedFile::close()
+{
+	if (address != nullptr)
+	{
+		munmap(address, size);
+		address = nullptr;
+		size = 0;
+	}
+}
+
+// ----------------------adviseSequential()----------------------------------
+// --Tells the kernel that bytes from to from + length will be read in
+//   order, so it reads ahead aggressively.
+// --------------------------------------------------------------------------
+void MappedFile::adviseSequential(const size_t& from, const size_t& length) const
+{
+	size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	size_t start = from - from % page;
+
+	if (address != nullptr && start < size)
+	{
+		size_t span = length + (from - start);
+		madvise(static_cast<char*>(address) + start, span < size - start ? span : size - start, MADV_SEQUENTIAL);
+	}
+}
+
+// ----------------------------getData()-------------------------------------
+// --Returns the first byte of the file, nullptr when closed.
+// --------------------------------------------------------------------------
+const unsigned char* MappedFile::getData() const
+{
+	return static_cast<const unsigned char*>(address);
+}
+
+// ----------------------------getSize()-------------------------------------
+// --Returns the length of the mapped file in bytes.
+// --------------------------------------------------------------------------
+size_t MappedFile::getSize() const
+{
+	return size;
+}
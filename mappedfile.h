@@ -0,0 +1,49 @@
+// ---------------------- mappedfile.h ------------------------------------
+//
+// Ethan Thomas
+// ------------------------------------------------------------------------
+// --Purpose: Map a whole file into memory read-only, so that large graph
+//   and result files are paged in by the operating system as they are
+//   touched instead of being read into the heap.
+// ------------------------------------------------------------------------
+// Assumptions:
+// --POSIX mmap is available.
+// --The file is not changed by anyone else while it is mapped.
+// --The mapping is released when the MappedFile is destroyed, so it is
+//   held behind a shared handle by everything pointing into it.
+// ------------------------------------------------------------------------
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+#include <string>
+#include <cstddef>
+
+
+class MappedFile
+{
+
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool open(const std::string& path);
+	void close();
+
+	void adviseSequential(const size_t& from, const size_t& length) const;
+
+	const unsigned char* getData() const;
+	size_t getSize() const;
+
+
+
+private:
+
+	void* address;          // start of the mapping, nullptr when closed
+	size_t size;            // length of the file
+
+
+};
+#endif // !MAPPEDFILE_H
@@ -0,0 +1,441 @@
+// ---------------------- queryserver.cpp ---------------------------------
+//
+// Ethan Thomas
+//
+// --------------------------------------------------------------------------
+#include "queryserver.h"
+#include <sstream>
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// --------------------------Constructor-------------------------------------
+// --Takes over graph and finds all of its shortest paths, so that the
+//   first queries are answered without solving.
+// --------------------------------------------------------------------------
+QueryServer::QueryServer(GraphM graph)
+	: graph(std::move(graph)), changes(0), buffer(SERVER_READ_BUFFER), stopped(false)
+{
+	this->graph.findShortestPath();
+	fresh.assign(this->graph.getSize() + 1, 0);
+}
+
+// ----------------------------serve()---------------------------------------
+// --Answers requests read from file descriptor in, writing the answers to
+//   out, until in is closed or a quit request arrives. Returns true if the
+//   server was told to quit.
+// --------------------------------------------------------------------------
+bool QueryServer::serve(const int& in, const int& out)
+{
+	Connection connection = { in, out, std::string(), std::string(), false, false };
+
+	while (!stopped && !connection.closed)
+	{
+		receive(connection);
+
+		if (!writeAll(out, connection.unsent))
+		{
+			break;
+		}
+
+		connection.unsent.clear();
+	}
+
+	return stopped;
+}
+
+// ----------------------------listen()--------------------------------------
+// --Serves every client connecting to a Unix socket at socketPath, polling
+//   them all from this thread, until one of them sends quit. A client with
+//   SERVER_UNSENT_LIMIT bytes of answers unread is not read from. A stale
+//   socket left at socketPath is replaced. Returns false if the socket
+//   could not be set up.
+// --------------------------------------------------------------------------
+bool QueryServer::listen(const std::string& socketPath)
+{
+	sockaddr_un address = sockaddr_un();
+	struct stat info;
+
+	if (socketPath.size() >= sizeof(address.sun_path))
+	{
+		return false;
+	}
+
+	address.sun_family = AF_UNIX;
+	socketPath.copy(address.sun_path, socketPath.size());
+
+	if (stat(socketPath.c_str(), &info) == 0 && S_ISSOCK(info.st_mode))
+	{
+		unlink(socketPath.c_str());
+	}
+
+	int server = socket(AF_UNIX, SOCK_STREAM, 0);
+
+	if (server < 0)
+	{
+		return false;
+	}
+
+	if (bind(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+		::listen(server, SERVER_BACKLOG) != 0)
+	{
+		::close(server);
+		return false;
+	}
+
+	signal(SIGPIPE, SIG_IGN); // a client hanging up must not end the server
+
+	std::vector<Connection> clients;
+	std::vector<pollfd> polled;
+
+	while (!stopped)
+	{
+		polled.clear();
+		polled.push_back(pollfd());
+		polled[0].fd = server;
+		polled[0].events = POLLIN;
+
+		for (size_t i = 0; i < clients.size(); i++)
+		{
+			pollfd entry = pollfd();
+			entry.fd = clients[i].in;
+			entry.events = static_cast<short>((isReading(clients[i]) ? POLLIN : 0) |
+				(clients[i].unsent.empty() ? 0 : POLLOUT));
+			polled.push_back(entry);
+		}
+
+		if (poll(polled.data(), polled.size(), -1) < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			break;
+		}
+
+		for (size_t i = 0; i < clients.size() && !stopped; i++)
+		{
+			Connection& client = clients[i];
+
+			if (isReading(client) && (polled[i + 1].revents & (POLLIN | POLLHUP | POLLERR)) != 0)
+			{
+				receive(client);
+			}
+
+			if (!client.unsent.empty() && !writeSome(client))
+			{
+				client.closed = true;   // gone; nothing more can reach it
+				client.unsent.clear();
+			}
+		}
+
+		for (size_t i = clients.size(); i > 0; i--) // drop finished clients
+		{
+			if (clients[i - 1].closed && clients[i - 1].unsent.empty())
+			{
+				::close(clients[i - 1].in);
+				clients.erase(clients.begin() + (i - 1));
+			}
+		}
+
+		if (!stopped && (polled[0].revents & POLLIN) != 0)
+		{
+			int client = accept(server, nullptr, nullptr);
+
+			if (client >= 0)
+			{
+				fcntl(client, F_SETFL, fcntl(client, F_GETFL) | O_NONBLOCK);
+				Connection connection = { client, client, std::string(), std::string(), false, false };
+				clients.push_back(connection);
+			}
+		}
+	}
+
+	for (size_t i = 0; i < clients.size(); i++) // the last answers, such as bye
+	{
+		writeSome(clients[i]);
+		::close(clients[i].in);
+	}
+
+	::close(server);
+	unlink(socketPath.c_str());
+	return true;
+}
+
+// ----------------------------answer()--------------------------------------
+// --Carries out one request and appends its answer line to response.
+// --------------------------------------------------------------------------
+void QueryServer::answer(const std::string& request, std::string& response)
+{
+	std::istringstream line(request);
+	std::string command;
+	int source = 0, destination = 0, distance = 0;
+
+	if (!(line >> command) || command[0] == '#') // blank line or comment
+	{
+		return;
+	}
+
+	if (command == "dist" || command == "path" || command == "reach")
+	{
+		if (!readNodes(line, source, destination, response))
+		{
+			return;
+		}
+
+		solve(source);
+		distance = graph.getDist(source, destination);
+
+		response += command + ' ' + std::to_string(source) + ' ' + std::to_string(destination);
+
+		if (command == "reach")
+		{
+			response += distance < INT_MAX ? " yes" : " no";
+		}
+		else if (distance == INT_MAX)
+		{
+			response += " none";
+		}
+		else
+		{
+			response += ' ' + std::to_string(distance);
+
+			if (command == "path")
+			{
+				std::vector<int> path;
+				graph.getPath(source, destination, path);
+
+				for (size_t i = 0; i < path.size(); i++)
+				{
+					response += ' ' + std::to_string(path[i]);
+				}
+			}
+		}
+
+		response += '\n';
+	}
+	else if (command == "insert" || command == "remove")
+	{
+		if (!readNodes(line, source, destination, response))
+		{
+			return;
+		}
+
+		distance = INT_MAX; // remove
+
+		if (command == "insert" && !(line >> distance))
+		{
+			response += "error expected: insert source destination distance\n";
+		}
+		else if (!graph.setEdge(source, destination, distance))
+		{
+			response += "error invalid edge\n";
+		}
+		else
+		{
+			++changes; // every row is stale until its source is asked about
+			response += "ok\n";
+		}
+	}
+	else if (command == "quit")
+	{
+		stopped = true;
+		response += "bye\n";
+	}
+	else
+	{
+		response += "error unknown request " + command.substr(0, SERVER_ECHO_LENGTH) + '\n';
+	}
+}
+
+// ---------------------------receive()--------------------------------------
+// --Helper function that reads what connection has sent, answers every
+//   complete request into connection.unsent, and keeps the rest for the
+//   next read. When in ends, a last request without a newline is answered
+//   and connection is marked closed. Returns false once closed.
+// --A request longer than SERVER_READ_BUFFER is answered with an error,
+//   whether its newline has arrived or not, and the rest of it is skipped.
+// --------------------------------------------------------------------------
+bool QueryServer::receive(Connection& connection)
+{
+	ssize_t got = ::read(connection.in, buffer.data(), buffer.size());
+
+	if (got < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK))
+	{
+		return true; // nothing yet
+	}
+
+	if (got <= 0) // closed, or the client went away
+	{
+		if (!connection.skipping && !stopped)
+		{
+			answer(connection.pending, connection.unsent);
+		}
+
+		connection.pending.clear();
+		connection.closed = true;
+		return false;
+	}
+
+	TRACE_SCOPE_ARG("QueryServer::batch", "bytes", static_cast<int>(got));
+
+	size_t start = 0, end = 0;
+	connection.pending.append(buffer.data(), static_cast<size_t>(got));
+
+	while (!stopped && (end = connection.pending.find('\n', start)) != std::string::npos)
+	{
+		if (connection.skipping) // the end of a request that was too long
+		{
+			connection.skipping = false;
+		}
+		else if (end - start > static_cast<size_t>(SERVER_READ_BUFFER))
+		{
+			connection.unsent += "error request too long\n";
+		}
+		else
+		{
+			answer(connection.pending.substr(start, end - start), connection.unsent);
+		}
+
+		start = end + 1;
+	}
+
+	connection.pending.erase(0, start);
+
+	if (stopped)
+	{
+		connection.pending.clear();
+	}
+	else if (connection.pending.size() > static_cast<size_t>(SERVER_READ_BUFFER))
+	{
+		if (!connection.skipping)
+		{
+			connection.unsent += "error request too long\n";
+		}
+
+		connection.pending.clear();
+		connection.skipping = true;
+	}
+
+	return true;
+}
+
+// ----------------------------solve()---------------------------------------
+// --Helper function that finds the shortest paths from source again if an
+//   edge has changed since they were last found.
+// --------------------------------------------------------------------------
+void QueryServer::solve(const int& source)
+{
+	if (fresh[source] != changes)
+	{
+		graph.findShortestPath(source, QueryWorkspace::local());
+		fresh[source] = changes;
+	}
+}
+
+// --------------------------readNodes()-------------------------------------
+// --Helper function that reads a source and destination node from line.
+//   Returns false, after appending an error to response, if either is
+//   missing or not a node of the graph.
+// --------------------------------------------------------------------------
+bool QueryServer::readNodes(std::istream& line, int& source, int& destination,
+	std::string& response) const
+{
+	if (!(line >> source >> destination))
+	{
+		response += "error expected source and destination nodes\n";
+		return false;
+	}
+
+	if (source <= 0 || source > graph.getSize() ||
+		destination <= 0 || destination > graph.getSize())
+	{
+		response += "error node out of range\n";
+		return false;
+	}
+
+	return true;
+}
+
+// ---------------------------isReading()------------------------------------
+// --Helper function returning true if more requests should be read from
+//   connection: it has not closed and has not fallen too far behind in
+//   reading its answers.
+// --------------------------------------------------------------------------
+bool QueryServer::isReading(const Connection& connection)
+{
+	return !connection.closed &&
+		connection.unsent.size() < static_cast<size_t>(SERVER_UNSENT_LIMIT);
+}
+
+// ---------------------------writeAll()-------------------------------------
+// --Helper function that writes all of text to file descriptor out.
+//   Returns false if out was closed.
+// --------------------------------------------------------------------------
+bool QueryServer::writeAll(const int& out, const std::string& text)
+{
+	size_t written = 0;
+
+	while (written < text.size())
+	{
+		ssize_t put = ::write(out, text.data() + written, text.size() - written);
+
+		if (put < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if (put <= 0)
+		{
+			return false;
+		}
+
+		written += static_cast<size_t>(put);
+	}
+
+	return true;
+}
+
+// ---------------------------writeSome()------------------------------------
+// --Helper function that writes as much of connection.unsent as the
+//   client will take without blocking, and keeps the rest. Returns false
+//   if the client is gone.
+// --------------------------------------------------------------------------
+bool QueryServer::writeSome(Connection& connection)
+{
+	size_t written = 0;
+	bool alive = true;
+
+	while (written < connection.unsent.size())
+	{
+		ssize_t put = ::write(connection.out, connection.unsent.data() + written,
+			connection.unsent.size() - written);
+
+		if (put < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if (put < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+		{
+			break; // the rest goes when poll() says it can
+		}
+
+		if (put <= 0)
+		{
+			alive = false;
+			break;
+		}
+
+		written += static_cast<size_t>(put);
+	}
+
+	connection.unsent.erase(0, written);
+	return alive;
+}
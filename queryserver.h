@@ -0,0 +1,91 @@
+// ---------------------- queryserver.h -----------------------------------
+//
+// Ethan Thomas
+// ------------------------------------------------------------------------
+// --Purpose: Answer shortest path queries against one resident GraphM, so
+//   that a lookup costs a table read instead of parsing, solving and
+//   printing the whole graph again. Requests are lines of text read from
+//   stdin or from clients of a Unix socket; each gets one line back.
+//       dist s d       ->  dist s d <distance>      or  dist s d none
+//       path s d       ->  path s d <distance> s ... d   or  path s d none
+//       reach s d      ->  reach s d yes             or  reach s d no
+//       insert s d w   ->  ok          sets the cost of edge s -> d to w
+//       remove s d     ->  ok          removes edge s -> d
+//       quit           ->  bye         stops the server
+//   Anything else, a node out of range, or a request longer than
+//   SERVER_READ_BUFFER bytes is answered with "error <reason>". Blank lines
+//   and lines starting with # are skipped without an answer. A last
+//   request without a newline is answered when its client closes.
+// ------------------------------------------------------------------------
+// Assumptions:
+// --Distances and paths are those of GraphM::display(), read from the
+//   results of the last findShortestPath().
+// --Requests are handled in batches: everything that arrives in one read
+//   is answered in order and the answers go back together.
+// --An edge change only marks every source's row of results stale. A query
+//   from a stale source first runs Dijkstra's algorithm from that source
+//   alone, so an update costs one single-source run per source asked
+//   about afterwards rather than all pairs again.
+// --Socket clients are served by one thread that polls every connection,
+//   so a client that stays connected without sending anything does not
+//   hold up the others. Answers to a client that is slow to read wait in
+//   its own buffer; once SERVER_UNSENT_LIMIT bytes are waiting, no more of
+//   its requests are read until it has taken some of them.
+// --Each batch is recorded as a trace span (see trace.h).
+// ------------------------------------------------------------------------
+
+#ifndef QUERYSERVER_H
+#define QUERYSERVER_H
+#include <string>
+#include <vector>
+#include "graphm.h"
+
+
+const int SERVER_READ_BUFFER = 1 << 16; //bytes read per batch, and longest request
+const int SERVER_BACKLOG = 16;          //clients waiting to connect
+const int SERVER_UNSENT_LIMIT = 1 << 20; //answer bytes a client may leave unread
+const int SERVER_ECHO_LENGTH = 32;      //characters of an unknown request echoed back
+
+class QueryServer
+{
+
+public:
+	explicit QueryServer(GraphM graph);
+
+	bool serve(const int& in, const int& out);
+	bool listen(const std::string& socketPath);
+
+	void answer(const std::string& request, std::string& response);
+
+
+
+private:
+
+	struct Connection
+	{
+		int in;                 // file descriptor requests are read from
+		int out;                // file descriptor answers are written to
+		std::string pending;    // a request cut off at the end of the last read
+		std::string unsent;     // answers not yet written
+		bool skipping;          // dropping the rest of a request that is too long
+		bool closed;            // in has ended or failed
+	};
+
+	bool receive(Connection& connection);
+	void solve(const int& source);
+	bool readNodes(std::istream& line, int& source, int& destination,
+		std::string& response) const;
+
+	static bool isReading(const Connection& connection);
+	static bool writeAll(const int& out, const std::string& text);
+	static bool writeSome(Connection& connection);
+
+	GraphM graph;                  // the resident graph
+	long long changes;             // edge changes made so far
+	std::vector<long long> fresh;  // changes when each source's row was found
+	std::vector<char> buffer;      // bytes of the current read
+	bool stopped;                  // set by a quit request
+
+
+};
+#endif // !QUERYSERVER_H
@@ -0,0 +1,79 @@
+// -------------------- queryworkspace.cpp --------------------------------
+//
+// Ethan Thomas
+//
+// --------------------------------------------------------------------------
+#include "queryworkspace.h"
+
+// -----------------------Default Constructor--------------------------------
+// --Constructs a workspace without any buffers. The first begin() sizes
+//   them.
+// --------------------------------------------------------------------------
+QueryWorkspace::QueryWorkspace()
+	: generation(1)
+{
+}
+
+// -----------------------Constructor----------------------------------------
+// --Constructs a workspace with buffers for vertices 0 to capacity - 1.
+// --------------------------------------------------------------------------
+QueryWorkspace::QueryWorkspace(const int& capacity)
+	: generation(1)
+{
+	reserve(capacity);
+}
+
+// ----------------------local()---------------------------------------------
+// --Returns the calling thread's workspace.
+// --------------------------------------------------------------------------
+QueryWorkspace& QueryWorkspace::local()
+{
+	static thread_local QueryWorkspace workspace;
+	return workspace;
+}
+
+// ----------------------reserve()-------------------------------------------
+// --Grows the buffers to hold vertices 0 to capacity - 1. Buffers never
+//   shrink, so a workspace reused for graphs of the same size allocates
+//   only on its first query. New entries start out stale.
+// --------------------------------------------------------------------------
+void QueryWorkspace::reserve(const int& capacity)
+{
+	if (capacity > static_cast<int>(dist.size()))
+	{
+		dist.resize(capacity, INT_MAX);
+		parent.resize(capacity, 0);
+		distStamp.resize(capacity, 0);
+		visitStamp.resize(capacity, 0);
+		heap.reserve(capacity);
+		frontier.reserve(capacity);
+	}
+}
+
+// ----------------------begin()---------------------------------------------
+// --Starts a new query over vertices 0 to capacity - 1 in O(1): every entry
+//   written by an earlier query becomes stale and the heap and frontier are
+//   emptied.
+// --------------------------------------------------------------------------
+void QueryWorkspace::begin(const int& capacity)
+{
+	reserve(capacity);
+	heap.clear();
+	frontier.clear();
+
+	if (++generation == 0) // counter wrapped, old stamps could match again
+	{
+		clearStamps();
+		generation = 1;
+	}
+}
+
+// ----------------------clearStamps()---------------------------------------
+// --Helper function that marks every entry stale after the generation
+//   counter wraps around.
+// --------------------------------------------------------------------------
+void QueryWorkspace::clearStamps()
+{
+	std::fill(distStamp.begin(), distStamp.end(), 0u);
+	std::fill(visitStamp.begin(), visitStamp.end(), 0u);
+}
@@ -0,0 +1,151 @@
+// -------------------- queryworkspace.h ----------------------------------
+//
+// Ethan Thomas
+// ------------------------------------------------------------------------
+// --Purpose: Scratch space for one graph query (a single-source Dijkstra
+//   run or a depth-first search): distance, parent and visited per vertex,
+//   a heap of (distance, vertex) pairs, and a frontier of vertices used as
+//   the stack or queue of a traversal. The buffers are sized once and
+//   reused, so a query neither allocates nor clears them.
+// ------------------------------------------------------------------------
+// Assumptions:
+// --Every entry carries the generation it was last written in. begin()
+//   starts a new query by bumping the generation, so an entry from an
+//   earlier query reads as unvisited, at infinite distance and without a
+//   parent. The stamps are only cleared in bulk when the generation counter
+//   wraps around.
+// --A workspace is used by one thread at a time. local() returns one per
+//   thread.
+// ------------------------------------------------------------------------
+
+#ifndef QUERYWORKSPACE_H
+#define QUERYWORKSPACE_H
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <climits>
+
+
+class QueryWorkspace
+{
+
+public:
+	QueryWorkspace();
+	explicit QueryWorkspace(const int& capacity);
+
+	static QueryWorkspace& local();
+
+	void reserve(const int& capacity);
+	void begin(const int& capacity);
+
+	bool isVisited(const int& vertex) const;
+	void markVisited(const int& vertex);
+
+	int getDist(const int& vertex) const;
+	int getParent(const int& vertex) const;
+	void setDist(const int& vertex, const int& distance, const int& parent);
+
+	bool heapEmpty() const;
+	void pushHeap(const int& distance, const int& vertex);
+	std::pair<int, int> popHeap();
+
+	std::vector<int>& getFrontier();
+
+
+
+private:
+
+	void clearStamps();
+
+	std::vector<int> dist;                     // distance from the source
+	std::vector<int> parent;                   // previous vertex on the path, 0 if none
+	std::vector<unsigned> distStamp;           // generation dist and parent were set in
+	std::vector<unsigned> visitStamp;          // generation the vertex was visited in
+	std::vector<std::pair<int, int> > heap;    // (distance, vertex), smallest on top
+	std::vector<int> frontier;                 // traversal stack or queue
+	unsigned generation;                       // current query
+
+
+};
+
+// ----------------------isVisited()-----------------------------------------
+// --Returns true if vertex was visited in the current query.
+// --------------------------------------------------------------------------
+inline bool QueryWorkspace::isVisited(const int& vertex) const
+{
+	return visitStamp[vertex] == generation;
+}
+
+// ----------------------markVisited()---------------------------------------
+// --Marks vertex visited in the current query.
+// --------------------------------------------------------------------------
+inline void QueryWorkspace::markVisited(const int& vertex)
+{
+	visitStamp[vertex] = generation;
+}
+
+// ----------------------getDist()-------------------------------------------
+// --Returns the distance set for vertex in the current query, or INT_MAX.
+// --------------------------------------------------------------------------
+inline int QueryWorkspace::getDist(const int& vertex) const
+{
+	return distStamp[vertex] == generation ? dist[vertex] : INT_MAX;
+}
+
+// ----------------------getParent()-----------------------------------------
+// --Returns the parent set for vertex in the current query, or 0.
+// --------------------------------------------------------------------------
+inline int QueryWorkspace::getParent(const int& vertex) const
+{
+	return distStamp[vertex] == generation ? parent[vertex] : 0;
+}
+
+// ----------------------setDist()-------------------------------------------
+// --Sets the distance and parent of vertex for the current query.
+// --------------------------------------------------------------------------
+inline void QueryWorkspace::setDist(const int& vertex, const int& distance, const int& parent)
+{
+	dist[vertex] = distance;
+	this->parent[vertex] = parent;
+	distStamp[vertex] = generation;
+}
+
+// ----------------------heapEmpty()-----------------------------------------
+// --Returns true if the heap holds no entries.
+// --------------------------------------------------------------------------
+inline bool QueryWorkspace::heapEmpty() const
+{
+	return heap.empty();
+}
+
+// ----------------------pushHeap()------------------------------------------
+// --Adds a (distance, vertex) entry to the heap.
+// --------------------------------------------------------------------------
+inline void QueryWorkspace::pushHeap(const int& distance, const int& vertex)
+{
+	heap.push_back(std::make_pair(distance, vertex));
+	std::push_heap(heap.begin(), heap.end(), std::greater<std::pair<int, int> >());
+}
+
+// ----------------------popHeap()-------------------------------------------
+// --Removes and returns the entry with the smallest distance, the smallest
+//   vertex first among equal distances.
+// --------------------------------------------------------------------------
+inline std::pair<int, int> QueryWorkspace::popHeap()
+{
+	std::pop_heap(heap.begin(), heap.end(), std::greater<std::pair<int, int> >());
+	std::pair<int, int> top = heap.back();
+	heap.pop_back();
+	return top;
+}
+
+// ----------------------getFrontier()--------------------------------------
+// --Returns the frontier buffer, empty at the start of each query.
+// --------------------------------------------------------------------------
+inline std::vector<int>& QueryWorkspace::getFrontier()
+{
+	return frontier;
+}
+
+#endif // !QUERYWORKSPACE_H
@@ -0,0 +1,275 @@
+// ------------------------- trace.cpp ------------------------------------
+//
+// Ethan Thomas
+//
+// --------------------------------------------------------------------------
+#include "trace.h"
+#include <fstream>
+#include <iomanip>
+
+std::atomic<bool> Trace::enabled(false);
+
+// ----------------------------enable()--------------------------------------
+// --Starts (on is true) or stops recording spans. Spans already recorded
+//   are kept.
+// --------------------------------------------------------------------------
+void Trace::enable(const bool& on)
+{
+	enabled.store(on, std::memory_order_relaxed);
+}
+
+// ---------------------------nameThread()-----------------------------------
+// --Names the calling thread in the export, such as "parser" or "worker".
+//   Has no effect while tracing is disabled.
+// --------------------------------------------------------------------------
+void Trace::nameThread(const char* name)
+{
+	if (isEnabled())
+	{
+		int thread = localBuffer().thread;
+		std::lock_guard<std::mutex> guard(registry().lock);
+		registry().names[thread - 1] = name;
+	}
+}
+
+// ----------------------------record()--------------------------------------
+// --Appends a span to the calling thread's ring buffer, overwriting the
+//   oldest span once the buffer is full. Only this thread writes the
+//   buffer, so publishing the span is a single release store of head.
+// --Writing a slot is the writer half of a sequence lock: the fence
+//   orders the overwrite after any earlier head the exporter checks.
+// --------------------------------------------------------------------------
+void Trace::record(const char* name, const char* argName, const int& arg,
+	const int64_t& start, const int64_t& end)
+{
+	ThreadBuffer& buffer = localBuffer();
+	uint64_t head = buffer.head.load(std::memory_order_relaxed);
+	Event& event = buffer.events[head % TRACE_BUFFER_EVENTS];
+
+	// keeps the stores below from showing before an export can see head
+	// move past this slot; pairs with the acquire fence in exportJson()
+	std::atomic_thread_fence(std::memory_order_release);
+
+	event.name.store(name, std::memory_order_relaxed);
+	event.argName.store(argName, std::memory_order_relaxed);
+	event.arg.store(arg, std::memory_order_relaxed);
+	event.start.store(start, std::memory_order_relaxed);
+	event.duration.store(end - start, std::memory_order_relaxed);
+	event.thread.store(buffer.thread, std::memory_order_relaxed);
+
+	buffer.head.store(head + 1, std::memory_order_release);
+}
+
+// ---------------------------exportJson()-----------------------------------
+// --Writes every recorded span to out as a Chrome trace event file: one
+//   complete ("X") event per span, timed in microseconds from the first
+//   span, and a thread_name event for each named thread.
+// --A span is only written if the thread had not started overwriting its
+//   slot by the time it was read.
+// --------------------------------------------------------------------------
+void Trace::exportJson(std::ostream& out)
+{
+	struct Snapshot
+	{
+		int thread;
+		const char* name;
+		const char* argName;
+		int arg;
+		int64_t start;
+		int64_t duration;
+	};
+
+	std::vector<ThreadBuffer*> buffers;
+	std::vector<const char*> names;
+	std::vector<Snapshot> spans;
+	bool first = true;
+
+	{
+		std::lock_guard<std::mutex> guard(registry().lock);
+
+		for (size_t b = 0; b < registry().buffers.size(); b++)
+		{
+			buffers.push_back(registry().buffers[b].get());
+		}
+
+		names = registry().names;
+	}
+
+	for (size_t b = 0; b < buffers.size(); b++)
+	{
+		ThreadBuffer& buffer = *buffers[b];
+		uint64_t head = buffer.head.load(std::memory_order_acquire);
+		uint64_t oldest = head > TRACE_BUFFER_EVENTS ? head - TRACE_BUFFER_EVENTS : 0;
+		size_t taken = spans.size();
+
+		for (uint64_t i = oldest; i < head; i++)
+		{
+			Event& event = buffer.events[i % TRACE_BUFFER_EVENTS];
+			Snapshot span;
+
+			span.thread = event.thread.load(std::memory_order_relaxed);
+			span.name = event.name.load(std::memory_order_relaxed);
+			span.argName = event.argName.load(std::memory_order_relaxed);
+			span.arg = event.arg.load(std::memory_order_relaxed);
+			span.start = event.start.load(std::memory_order_relaxed);
+			span.duration = event.duration.load(std::memory_order_relaxed);
+			spans.push_back(span);
+		}
+
+		// spans the thread may have overwritten while they were read
+		std::atomic_thread_fence(std::memory_order_acquire);
+		uint64_t after = buffer.head.load(std::memory_order_relaxed);
+		uint64_t overwritten = after >= TRACE_BUFFER_EVENTS ? after - TRACE_BUFFER_EVENTS + 1 : 0;
+
+		if (overwritten > oldest)
+		{
+			uint64_t drop = overwritten - oldest < head - oldest ? overwritten - oldest : head - oldest;
+			spans.erase(spans.begin() + taken, spans.begin() + taken + static_cast<size_t>(drop));
+		}
+	}
+
+	int64_t origin = spans.empty() ? 0 : spans[0].start;
+
+	for (size_t i = 1; i < spans.size(); i++)
+	{
+		origin = spans[i].start < origin ? spans[i].start : origin;
+	}
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	for (size_t t = 0; t < names.size(); t++)
+	{
+		if (names[t] != nullptr)
+		{
+			out << (first ? "\n" : ",\n");
+			out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t + 1;
+			out << ",\"args\":{\"name\":";
+			writeString(out, names[t]);
+			out << "}}";
+			first = false;
+		}
+	}
+
+	out << std::fixed << std::setprecision(3);
+
+	for (size_t i = 0; i < spans.size(); i++)
+	{
+		out << (first ? "\n" : ",\n");
+		out << "{\"name\":";
+		writeString(out, spans[i].name);
+		out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << spans[i].thread;
+		out << ",\"ts\":" << (spans[i].start - origin) / 1000.0;
+		out << ",\"dur\":" << spans[i].duration / 1000.0;
+
+		if (spans[i].argName != nullptr)
+		{
+			out << ",\"args\":{";
+			writeString(out, spans[i].argName);
+			out << ":" << spans[i].arg << "}";
+		}
+
+		out << "}";
+		first = false;
+	}
+
+	out << "\n]}\n";
+}
+
+// ---------------------------exportJson()-----------------------------------
+// --Writes every recorded span to a file at path. Returns false if the
+//   file could not be written.
+// --------------------------------------------------------------------------
+bool Trace::exportJson(const std::string& path)
+{
+	std::ofstream file(path.c_str());
+
+	exportJson(file);
+	file.close();
+	return !file.fail();
+}
+
+// ---------------------------registry()-------------------------------------
+// --Helper function returning the list of every thread's buffer.
+// --------------------------------------------------------------------------
+Trace::Registry& Trace::registry()
+{
+	static Registry everyThread;
+	return everyThread;
+}
+
+// --------------------------localBuffer()-----------------------------------
+// --Helper function returning the calling thread's ring buffer. On the
+//   thread's first span it takes the buffer of a thread that has ended, or
+//   creates and registers a new one, and gives the thread the next number.
+//   The registry owns every buffer, so spans of ended threads can still be
+//   exported.
+// --------------------------------------------------------------------------
+Trace::ThreadBuffer& Trace::localBuffer()
+{
+	static thread_local Lease lease = { nullptr };
+
+	if (lease.buffer == nullptr)
+	{
+		Registry& everyThread = registry();
+		std::lock_guard<std::mutex> guard(everyThread.lock);
+
+		if (!everyThread.idle.empty())
+		{
+			lease.buffer = everyThread.idle.back();
+			everyThread.idle.pop_back();
+		}
+		else
+		{
+			std::unique_ptr<ThreadBuffer> created(new ThreadBuffer());
+
+			created->head.store(0, std::memory_order_relaxed);
+			lease.buffer = created.get();
+			everyThread.buffers.push_back(std::move(created));
+		}
+
+		everyThread.names.push_back(nullptr);
+		lease.buffer->thread = static_cast<int>(everyThread.names.size());
+	}
+
+	return *lease.buffer;
+}
+
+// -------------------------Lease Destructor---------------------------------
+// --Runs when a thread that recorded spans ends, and hands its buffer to
+//   the next thread that records.
+// --------------------------------------------------------------------------
+Trace::Lease::~Lease()
+{
+	if (buffer != nullptr)
+	{
+		Registry& everyThread = registry();
+		std::lock_guard<std::mutex> guard(everyThread.lock);
+		everyThread.idle.push_back(buffer);
+	}
+}
+
+// --------------------------writeString()-----------------------------------
+// --Helper function writing text to out as a quoted JSON string.
+// --------------------------------------------------------------------------
+void Trace::writeString(std::ostream& out, const char* text)
+{
+	out << '"';
+
+	for (const char* c = text; *c != '\0'; c++)
+	{
+		if (*c == '"' || *c == '\\')
+		{
+			out << '\\' << *c;
+		}
+		else if (static_cast<unsigned char>(*c) < 0x20)
+		{
+			out << ' ';
+		}
+		else
+		{
+			out << *c;
+		}
+	}
+
+	out << '"';
+}
@@ -0,0 +1,196 @@
+// ------------------------- trace.h --------------------------------------
+//
+// Ethan Thomas
+// ------------------------------------------------------------------------
+// --Purpose: Timeline tracing of graph operations. A TraceSpan placed at
+//   the top of a scope records when the scope was entered, how long it
+//   ran and on which thread. Spans are kept per thread and exported in the
+//   Chrome trace event format, which chrome://tracing and the Perfetto UI
+//   open as a timeline with one row per thread.
+// ------------------------------------------------------------------------
+// Assumptions:
+// --Tracing starts disabled. While disabled a span costs one relaxed
+//   atomic load and a branch. Building with TRACE_DISABLED defined removes
+//   the spans entirely.
+// --Each thread writes its spans to its own ring buffer of
+//   TRACE_BUFFER_EVENTS entries without locking; once full, the oldest
+//   spans are overwritten. The buffer is allocated the first time the
+//   thread records a span. When the thread ends, its buffer and the spans
+//   in it are handed to the next thread that records. Each span keeps the
+//   number of the thread that recorded it, so the next thread gets a new
+//   number and no name until it is named. Buffers are freed when the
+//   program ends.
+// --exportJson() may run while other threads are still recording. It
+//   takes a snapshot of each buffer and leaves out any span that was
+//   being overwritten while it read.
+// --Span names and argument names are string literals; only the pointer
+//   is stored.
+// --Threads are numbered 1, 2, ... in the order they first record. The
+//   registry keeps one name pointer per thread number.
+// ------------------------------------------------------------------------
+
+#ifndef TRACE_H
+#define TRACE_H
+#include <iostream>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include <memory>
+
+
+const int TRACE_BUFFER_EVENTS = 1 << 14; //spans kept per thread
+
+class Trace
+{
+
+public:
+	static void enable(const bool& on);
+	static bool isEnabled();
+
+	static void nameThread(const char* name);
+
+	static int64_t now();
+	static void record(const char* name, const char* argName, const int& arg,
+		const int64_t& start, const int64_t& end);
+
+	static void exportJson(std::ostream& out);
+	static bool exportJson(const std::string& path);
+
+
+
+private:
+
+	struct Event
+	{
+		std::atomic<const char*> name;
+		std::atomic<const char*> argName;  // nullptr if the span has no argument
+		std::atomic<int> arg;
+		std::atomic<int64_t> start;        // nanoseconds, from now()
+		std::atomic<int64_t> duration;     // nanoseconds
+		std::atomic<int> thread;           // number of the thread that recorded it
+	};
+
+	struct ThreadBuffer
+	{
+		int thread;                          // number of the thread holding it
+		std::atomic<uint64_t> head;          // spans ever recorded
+		Event events[TRACE_BUFFER_EVENTS];   // span i is in events[i % size]
+	};
+
+	struct Registry
+	{
+		std::mutex lock;                                    // held only to hand out or list buffers
+		std::vector<std::unique_ptr<ThreadBuffer> > buffers; // every buffer handed out
+		std::vector<ThreadBuffer*> idle;                    // buffers of threads that ended
+		std::vector<const char*> names;                     // by thread number less one, nullptr if unnamed
+	};
+
+	struct Lease
+	{
+		ThreadBuffer* buffer;                // the thread's buffer, nullptr until it records
+		~Lease();
+	};
+
+	static Registry& registry();
+	static ThreadBuffer& localBuffer();
+	static void writeString(std::ostream& out, const char* text);
+
+	static std::atomic<bool> enabled;    // whether spans are recorded
+
+
+};
+
+// -------------------------- TraceSpan -------------------------------------
+// --Records the scope it is declared in as one span, if tracing was
+//   enabled when the scope was entered.
+// --------------------------------------------------------------------------
+class TraceSpan
+{
+
+public:
+	explicit TraceSpan(const char* name);
+	TraceSpan(const char* name, const char* argName, const int& arg);
+	~TraceSpan();
+
+	TraceSpan(const TraceSpan&) = delete;
+	TraceSpan& operator=(const TraceSpan&) = delete;
+
+
+
+private:
+
+	const char* name;       // nullptr when tracing was disabled
+	const char* argName;    // nullptr if there is no argument
+	int arg;
+	int64_t start;          // from Trace::now()
+
+
+};
+
+#ifdef TRACE_DISABLED
+#define TRACE_SCOPE(name)
+#define TRACE_SCOPE_ARG(name, argName, arg)
+#else
+#define TRACE_SCOPE(name) TraceSpan traceSpan(name)
+#define TRACE_SCOPE_ARG(name, argName, arg) TraceSpan traceSpan(name, argName, arg)
+#endif
+
+// ----------------------------isEnabled()-----------------------------------
+// --Returns true if spans are being recorded.
+// --------------------------------------------------------------------------
+inline bool Trace::isEnabled()
+{
+	return enabled.load(std::memory_order_relaxed);
+}
+
+// ------------------------------now()---------------------------------------
+// --Returns a monotonic timestamp in nanoseconds.
+// --------------------------------------------------------------------------
+inline int64_t Trace::now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// -----------------------TraceSpan Constructor------------------------------
+// --Starts a span named name without an argument.
+// --------------------------------------------------------------------------
+inline TraceSpan::TraceSpan(const char* name)
+	: name(nullptr), argName(nullptr), arg(0), start(0)
+{
+	if (Trace::isEnabled())
+	{
+		this->name = name;
+		start = Trace::now();
+	}
+}
+
+// -----------------------TraceSpan Constructor------------------------------
+// --Starts a span named name whose argument argName is arg, such as the
+//   source node of one Dijkstra run.
+// --------------------------------------------------------------------------
+inline TraceSpan::TraceSpan(const char* name, const char* argName, const int& arg)
+	: name(nullptr), argName(argName), arg(arg), start(0)
+{
+	if (Trace::isEnabled())
+	{
+		this->name = name;
+		start = Trace::now();
+	}
+}
+
+// -----------------------TraceSpan Destructor-------------------------------
+// --Ends the span and records it.
+// --------------------------------------------------------------------------
+inline TraceSpan::~TraceSpan()
+{
+	if (name != nullptr)
+	{
+		Trace::record(name, argName, arg, start, Trace::now());
+	}
+}
+
+#endif // !TRACE_H
@@ -0,0 +1,160 @@
+// ---------------------- vertexorder.cpp ---------------------------------
+//
+// Ethan Thomas
+//
+// --------------------------------------------------------------------------
+#include "vertexorder.h"
+#include <algorithm>
+
+namespace
+{
+
+// ----------------------undirected()----------------------------------------
+// --Builds ranges holding the neighbours of every vertex in either
+//   direction, each range sorted and without repeats.
+// --------------------------------------------------------------------------
+void undirected(const int& size, const std::vector<int>& offset,
+	const std::vector<int>& edges, std::vector<int>& outOffset,
+	std::vector<int>& outEdges)
+{
+	std::vector<std::vector<int> > adjacent(size + 1);
+
+	for (int v = 1; v <= size; v++)
+	{
+		for (int e = offset[v]; e < offset[v + 1]; e++)
+		{
+			adjacent[v].push_back(edges[e]);
+			adjacent[edges[e]].push_back(v);
+		}
+	}
+
+	outOffset.assign(size + 2, 0);
+	outEdges.clear();
+
+	for (int v = 1; v <= size; v++)
+	{
+		std::sort(adjacent[v].begin(), adjacent[v].end());
+		adjacent[v].erase(std::unique(adjacent[v].begin(), adjacent[v].end()),
+			adjacent[v].end());
+
+		outOffset[v] = static_cast<int>(outEdges.size());
+		outEdges.insert(outEdges.end(), adjacent[v].begin(), adjacent[v].end());
+	}
+
+	outOffset[size + 1] = static_cast<int>(outEdges.size());
+}
+
+// ----------------------breadthFirst()--------------------------------------
+// --Numbers the vertices in breadth-first order, starting each component at
+//   its lowest numbered vertex (BFS) or at its vertex of least degree
+//   (Cuthill-McKee). Cuthill-McKee also visits neighbours least degree
+//   first.
+// --------------------------------------------------------------------------
+std::vector<int> breadthFirst(const int& size, const std::vector<int>& offset,
+	const std::vector<int>& edges, const bool& byDegree)
+{
+	std::vector<int> order(1, 0);
+	std::vector<bool> placed(size + 1, false);
+	std::vector<int> starts, neighbours;
+
+	order.reserve(size + 1);
+
+	for (int v = 1; v <= size; v++)
+	{
+		starts.push_back(v);
+	}
+
+	if (byDegree)
+	{
+		std::stable_sort(starts.begin(), starts.end(), [&](int a, int b)
+		{
+			return offset[a + 1] - offset[a] < offset[b + 1] - offset[b];
+		});
+	}
+
+	for (size_t s = 0; s < starts.size(); s++)
+	{
+		if (placed[starts[s]])
+		{
+			continue;
+		}
+
+		size_t head = order.size();
+		order.push_back(starts[s]);
+		placed[starts[s]] = true;
+
+		for (; head < order.size(); head++) // order doubles as the queue
+		{
+			int v = order[head];
+			neighbours.assign(edges.begin() + offset[v], edges.begin() + offset[v + 1]);
+
+			if (byDegree)
+			{
+				std::stable_sort(neighbours.begin(), neighbours.end(), [&](int a, int b)
+				{
+					return offset[a + 1] - offset[a] < offset[b + 1] - offset[b];
+				});
+			}
+
+			for (size_t i = 0; i < neighbours.size(); i++)
+			{
+				if (!placed[neighbours[i]])
+				{
+					placed[neighbours[i]] = true;
+					order.push_back(neighbours[i]);
+				}
+			}
+		}
+	}
+
+	return order;
+}
+
+}
+
+// ----------------------vertexOrder()---------------------------------------
+// --Returns the new numbering as a list: entry k is the current number of
+//   the vertex that becomes vertex k. Entry 0 is always 0.
+// --------------------------------------------------------------------------
+std::vector<int> vertexOrder(const VertexOrder& order, const int& size,
+	const std::vector<int>& offset, const std::vector<int>& edges)
+{
+	std::vector<int> newToOld;
+	std::vector<int> bothOffset, bothEdges;
+
+	if (order == ORDER_IDENTITY || size <= 0)
+	{
+		for (int v = 0; v <= (size > 0 ? size : 0); v++)
+		{
+			newToOld.push_back(v);
+		}
+
+		return newToOld;
+	}
+
+	undirected(size, offset, edges, bothOffset, bothEdges);
+
+	if (order == ORDER_BFS)
+	{
+		newToOld = breadthFirst(size, bothOffset, bothEdges, false);
+	}
+	else if (order == ORDER_RCM)
+	{
+		newToOld = breadthFirst(size, bothOffset, bothEdges, true);
+		std::reverse(newToOld.begin() + 1, newToOld.end());
+	}
+	else // ORDER_DEGREE
+	{
+		for (int v = 0; v <= size; v++)
+		{
+			newToOld.push_back(v);
+		}
+
+		std::stable_sort(newToOld.begin() + 1, newToOld.end(), [&](int a, int b)
+		{
+			return bothOffset[a + 1] - bothOffset[a] > bothOffset[b + 1] - bothOffset[b];
+		});
+	}
+
+	return newToOld;
+}
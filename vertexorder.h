@@ -0,0 +1,38 @@
+// ---------------------- vertexorder.h -----------------------------------
+//
+// Ethan Thomas
+// ------------------------------------------------------------------------
+// --Purpose: Compute a new numbering of a graph's vertices that places
+//   vertices visited together next to each other in memory. GraphL uses it
+//   in relabel() to lay out its edge ranges in the new order, while its
+//   public functions keep using the original numbers. GraphM does not
+//   relabel: its Dijkstra scans whole rows of a matrix that fits in cache,
+//   so a new order would not make it faster.
+// ------------------------------------------------------------------------
+// Assumptions:
+// --Vertices are numbered 1 to size; 0 is unused, as in GraphL and GraphM.
+// --The graph is passed as ranges: the neighbours of v are
+//   edges[offset[v]] to edges[offset[v + 1] - 1].
+// --Edge direction is ignored when ordering; two vertices joined by an edge
+//   in either direction count as neighbours.
+// --Ties are always broken by the lower vertex number, so an ordering is
+//   reproducible for a given graph.
+// ------------------------------------------------------------------------
+
+#ifndef VERTEXORDER_H
+#define VERTEXORDER_H
+#include <vector>
+
+
+enum VertexOrder
+{
+	ORDER_IDENTITY,   // keep the current numbering
+	ORDER_BFS,        // breadth-first from the lowest numbered vertex of each component
+	ORDER_RCM,        // reverse Cuthill-McKee, for a narrow band around the diagonal
+	ORDER_DEGREE      // highest degree first, so hub vertices share cache lines
+};
+
+std::vector<int> vertexOrder(const VertexOrder& order, const int& size,
+	const std::vector<int>& offset, const std::vector<int>& edges);
+
+#endif // !VERTEXORDER_H